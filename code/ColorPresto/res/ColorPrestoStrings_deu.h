@@ -182,3 +182,21 @@ NA_LOC(CPPreferencesLanguageChangeAlertTitle, "Sprachänderung");
 NA_LOC(CPPreferencesLanguageChangeAlertText, "Die Sprache wurde geändert. Bitte beenden Sie die Anwendung und öffnen Sie sie erneut, damit die Änderungen wirksam werden.");
 NA_LOC(CPPreferencesLanguageBadTranslationTitle, "Schlechte Übersetzungen melden");
 NA_LOC(CPPreferencesLanguageBadTranslationText, "Einige Teile dieser Anwendung wurden von künstlicher Intelligenz übersetzt. Helfen Sie, die Übersetzung zu verbessern, indem Sie eine E-Mail an karograph@manderc.com senden (der Link dazu findet sich im Info-Fenster). Bitte geben Sie ausreichend Informationen an, um Ihren Vorschlag an der richtigen Stelle zu integrieren.\n\nIhre Hilfe wird sehr geschätzt!");
+
+// Translations for the rendering preferences
+NA_LOC(CPPreferencesThreeDeeRenderer,           "3D-Darstellung");
+NA_LOC(CPPreferencesThreeDeeRendererBuffers,    "Vertex-Arrays");
+NA_LOC(CPPreferencesThreeDeeRendererImmediate,  "Immediate Mode");
+NA_LOC(CPPreferencesColorLUT,                   "Farbtabelle");
+NA_LOC(CPPreferencesColorLUTOff,                "Aus (exakt)");
+NA_LOC(CPPreferencesColorLUT33,                 "33 pro Achse");
+NA_LOC(CPPreferencesColorLUT65,                 "65 pro Achse");
+NA_LOC(CPPreferencesResponseLUT,                "Antwortkurven");
+NA_LOC(CPPreferencesResponseLUTExact,           "Exakt");
+NA_LOC(CPPreferencesResponseLUT4096,            "Tabellen (4096)");
+NA_LOC(CPPreferencesWellDither,                 "Dithering der Farbfelder");
+NA_LOC(CPPreferencesWellDitherOrdered,          "Geordnet");
+NA_LOC(CPPreferencesWellDitherOff,              "Aus");
+NA_LOC(CPPreferencesProgressiveWells,           "Vorschau der Farbfelder beim Ziehen");
+NA_LOC(CPPreferencesProgressiveWellsOn,         "Ein");
+NA_LOC(CPPreferencesProgressiveWellsOff,        "Aus");
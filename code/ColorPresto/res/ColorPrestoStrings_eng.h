@@ -189,3 +189,21 @@ NA_LOC(CPPreferencesLanguageChangeAlertTitle, "Language Change");
 NA_LOC(CPPreferencesLanguageChangeAlertText, "The language has been changed. Please quit and reopen the application to take effect.");
 NA_LOC(CPPreferencesLanguageBadTranslationTitle, "Report bad translations");
 NA_LOC(CPPreferencesLanguageBadTranslationText, "Some parts of this application have been translated by artificial intelligence. Help improve the translation by sending an email to colorpresto@manderc.com (link is in the about window). Please provide sufficient information to incorporate your suggestion at the proper place.\n\nYour help is greatly appreciated!");
+
+// Translations for the rendering preferences
+NA_LOC(CPPreferencesThreeDeeRenderer,           "3D rendering");
+NA_LOC(CPPreferencesThreeDeeRendererBuffers,    "Vertex arrays");
+NA_LOC(CPPreferencesThreeDeeRendererImmediate,  "Immediate mode");
+NA_LOC(CPPreferencesColorLUT,                   "Color lookup table");
+NA_LOC(CPPreferencesColorLUTOff,                "Off (exact)");
+NA_LOC(CPPreferencesColorLUT33,                 "33 per axis");
+NA_LOC(CPPreferencesColorLUT65,                 "65 per axis");
+NA_LOC(CPPreferencesResponseLUT,                "Response curves");
+NA_LOC(CPPreferencesResponseLUTExact,           "Exact");
+NA_LOC(CPPreferencesResponseLUT4096,            "Tables (4096)");
+NA_LOC(CPPreferencesWellDither,                 "Color well dithering");
+NA_LOC(CPPreferencesWellDitherOrdered,          "Ordered");
+NA_LOC(CPPreferencesWellDitherOff,              "Off");
+NA_LOC(CPPreferencesProgressiveWells,           "Color well preview while dragging");
+NA_LOC(CPPreferencesProgressiveWellsOn,         "On");
+NA_LOC(CPPreferencesProgressiveWellsOff,        "Off");
@@ -0,0 +1,830 @@
+
+// Benchmark of the numeric hot paths of Color Presto. Every case runs under
+// a set of fixed machine presets such that results of different builds can
+// be compared. The results are written as JSON to stdout, one entry per case
+// and preset with the throughput and the latency percentiles of one run.
+// Additionally, the spectral matrix is checked against the integration of
+// CML and the process exits with failure if it deviates too much.
+
+#include "../mainC.h"
+
+#include "NAUtility/NAMemory.h"
+#include "../Core/CPColorLUT.h"
+#include "../Core/CPColorRenderingIndex.h"
+#include "../Core/CPColorWellValues.h"
+#include "../Core/CPRGBConversion.h"
+#include "../Core/CPResponseLUT.h"
+#include "../Core/CPScratchArena.h"
+#include "../Core/CPSpectralMatrix.h"
+#include "../Core/CPThreeDeeMesh.h"
+#include "../Core/CPThreeDeeTypes.h"
+#include "../Core/CPUVMetamericIndex.h"
+#include "../Core/CPVisMetamericIndex.h"
+#include "../Core/CPWhitePoints.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if NA_OS == NA_OS_WINDOWS
+  #include <windows.h>
+#else
+  #include <time.h>
+#endif
+
+
+
+// Every case is repeated until both bounds are reached or until the maximum
+// number of iterations has been measured.
+#define CP_BENCHMARK_MIN_ITERATIONS 5
+#define CP_BENCHMARK_MAX_ITERATIONS 1000
+#define CP_BENCHMARK_MIN_SECONDS .25
+
+// Same size as the wells in the machine window, see CPDesign.h.
+#define CP_BENCHMARK_WELL_SIZE 125
+
+typedef void(*CPBenchmarkFunction)(void* data);
+
+typedef struct CPBenchmarkPreset CPBenchmarkPreset;
+struct CPBenchmarkPreset{
+  const char* name;
+  CMLColorMachine* cm;
+  CMLColorMachine* sm;
+};
+
+// All color types which can be converted to screen RGB. The spectral types
+// are no arrays of normed values and are therefore not part of the list.
+static const CMLColorType cpBenchmarkColorTypes[] = {
+  CML_COLOR_Gray,
+  CML_COLOR_XYZ,
+  CML_COLOR_Yxy,
+  CML_COLOR_Yuv,
+  CML_COLOR_Yupvp,
+  CML_COLOR_Ycd,
+  CML_COLOR_Lab,
+  CML_COLOR_Lch,
+  CML_COLOR_Luv,
+  CML_COLOR_UVW,
+  CML_COLOR_RGB,
+  CML_COLOR_YCbCr,
+  CML_COLOR_HSV,
+  CML_COLOR_HSL,
+};
+#define CP_BENCHMARK_COLOR_TYPE_COUNT (sizeof(cpBenchmarkColorTypes) / sizeof(CMLColorType))
+
+static const size_t cpBenchmarkConversionCounts[] = {125, 15625, 1000000};
+#define CP_BENCHMARK_CONVERSION_COUNT_COUNT 3
+
+static const NAInt cpBenchmarkSteps3D[] = {10, 25, 40};
+#define CP_BENCHMARK_STEPS3D_COUNT 3
+
+// The color controllers of the machine window with the fixed channel of their
+// 2D well. Gray only has a 1D well. The spectral well depends on the GUI and
+// is not part of the benchmark.
+typedef struct CPBenchmarkWell CPBenchmarkWell;
+struct CPBenchmarkWell{
+  CMLColorType colorType;
+  NABool has2DWell;
+  size_t fixedIndex;
+};
+
+static const CPBenchmarkWell cpBenchmarkWells[] = {
+  {CML_COLOR_Gray,  NA_FALSE, 0},
+  {CML_COLOR_HSV,   NA_TRUE,  2},
+  {CML_COLOR_Lab,   NA_TRUE,  0},
+  {CML_COLOR_Luv,   NA_TRUE,  0},
+  {CML_COLOR_RGB,   NA_TRUE,  1},
+  {CML_COLOR_XYZ,   NA_TRUE,  1},
+  {CML_COLOR_YCbCr, NA_TRUE,  0},
+  {CML_COLOR_Yuv,   NA_TRUE,  0},
+  {CML_COLOR_Yxy,   NA_TRUE,  0},
+};
+#define CP_BENCHMARK_WELL_COUNT (sizeof(cpBenchmarkWells) / sizeof(CPBenchmarkWell))
+
+static const char* cpBenchmarkCoordSysNames[COORD_SYS_COUNT] = {
+  "HSL",
+  "HSL_CARTESIAN",
+  "HSV",
+  "HSV_CARTESIAN",
+  "Lab",
+  "Lch_CARTESIAN",
+  "Luv",
+  "RGB",
+  "UVW",
+  "XYZ",
+  "Ycbcr",
+  "Ycd",
+  "Yupvp",
+  "Yuv",
+  "Yxy",
+};
+
+static const char* cpBenchmarkReferenceNames[NUMBER_OF_REFERENCE_ILLUMINATIONS] = {
+  "D50",
+  "D55",
+  "D65",
+  "D75",
+};
+
+static NABool cpBenchmarkFirstResult = NA_TRUE;
+
+
+
+static double cp_GetBenchmarkSeconds(void){
+  #if NA_OS == NA_OS_WINDOWS
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+  #else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+  #endif
+}
+
+
+
+static int cp_CompareBenchmarkSeconds(const void* a, const void* b){
+  double secondsA = *(const double*)a;
+  double secondsB = *(const double*)b;
+  return (secondsA < secondsB) ? -1 : ((secondsA > secondsB) ? 1 : 0);
+}
+
+
+
+// Expects the latencies to be sorted.
+static double cp_GetBenchmarkPercentile(const double* latencies, size_t count, double percentile){
+  size_t index = (size_t)(percentile * (double)(count - 1) + .5);
+  return latencies[index];
+}
+
+
+
+static void cp_RunBenchmarkCase(
+  const char* caseName,
+  const char* variantName,
+  const CPBenchmarkPreset* preset,
+  size_t elementCount,
+  CPBenchmarkFunction function,
+  void* data)
+{
+  double* latencies = naMalloc(CP_BENCHMARK_MAX_ITERATIONS * sizeof(double));
+
+  // One run which is not measured to fill the caches. Afterwards, the
+  // scratch arena is expected to not grow any more.
+  function(data);
+  size_t heapAllocationCount = cpGetScratchArenaHeapAllocationCount();
+
+  double total = 0.;
+  size_t iterations = 0;
+  while(iterations < CP_BENCHMARK_MAX_ITERATIONS
+    && (iterations < CP_BENCHMARK_MIN_ITERATIONS || total < CP_BENCHMARK_MIN_SECONDS))
+  {
+    double start = cp_GetBenchmarkSeconds();
+    function(data);
+    latencies[iterations] = cp_GetBenchmarkSeconds() - start;
+    total += latencies[iterations];
+    iterations++;
+  }
+
+  heapAllocationCount = cpGetScratchArenaHeapAllocationCount() - heapAllocationCount;
+  qsort(latencies, iterations, sizeof(double), cp_CompareBenchmarkSeconds);
+
+  printf(cpBenchmarkFirstResult ? "\n" : ",\n");
+  cpBenchmarkFirstResult = NA_FALSE;
+  printf("    {\"case\": \"%s\", \"variant\": \"%s\", \"preset\": \"%s\", ", caseName, variantName, preset->name);
+  printf("\"elements\": %zu, \"iterations\": %zu, ", elementCount, iterations);
+  printf("\"elementsPerSecond\": %.1f, ", (double)(elementCount * iterations) / total);
+  printf("\"scratchHeapAllocations\": %zu, ", heapAllocationCount);
+  printf("\"latencyMicroseconds\": {\"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f}}",
+    cp_GetBenchmarkPercentile(latencies, iterations, .50) * 1e6,
+    cp_GetBenchmarkPercentile(latencies, iterations, .90) * 1e6,
+    cp_GetBenchmarkPercentile(latencies, iterations, .99) * 1e6);
+  fflush(stdout);
+
+  naFree(latencies);
+}
+
+
+
+// /////////////////////
+// Presets
+// /////////////////////
+
+static void cp_InitBenchmarkPreset(
+  CPBenchmarkPreset* preset,
+  const char* name,
+  CMLRGBColorSpaceType rgbColorSpaceType,
+  CMLIlluminationType illuminationType,
+  float customGamma)
+{
+  preset->name = name;
+  preset->cm = cmlCreateColorMachine();
+  preset->sm = cmlCreateColorMachine();
+
+  // Setting the color space resets the illumination, therefore the
+  // illumination comes second.
+  cmlSetRGBColorSpaceType(preset->cm, rgbColorSpaceType);
+  cmlSetIlluminationType(preset->cm, illuminationType);
+
+  if(customGamma > 0.f){
+    CMLResponseCurve* response = cmlAllocResponseCurve();
+    cmlInitResponseCurveWithCustomGamma(response, customGamma);
+    cmlSetResponseRGB(preset->cm, response);
+    cmlClearResponseCurve(response);
+    free(response);
+  }
+}
+
+
+
+static void cp_ClearBenchmarkPreset(CPBenchmarkPreset* preset){
+  cmlReleaseColorMachine(preset->sm);
+  cmlReleaseColorMachine(preset->cm);
+}
+
+
+
+// /////////////////////
+// RGB conversion
+// /////////////////////
+
+typedef struct CPConversionBenchmark CPConversionBenchmark;
+struct CPConversionBenchmark{
+  const CPBenchmarkPreset* preset;
+  CMLColorType colorType;
+  CMLNormedConverter normedConverter;
+  CPResponseLUT* responseLUT;
+  size_t count;
+  float* inputData;
+  float* outData;
+};
+
+
+
+static void cp_RunConversionBenchmark(void* data){
+  CPConversionBenchmark* bench = (CPConversionBenchmark*)data;
+  if(bench->responseLUT){
+    cpFillRGBFloatArrayWithResponseLUT(
+      bench->responseLUT,
+      0,
+      bench->preset->cm,
+      bench->preset->sm,
+      bench->outData,
+      bench->inputData,
+      bench->colorType,
+      bench->normedConverter,
+      bench->count);
+  }else{
+    fillRGBFloatArrayWithArray(
+      0,
+      bench->preset->cm,
+      bench->preset->sm,
+      bench->outData,
+      bench->inputData,
+      bench->colorType,
+      bench->normedConverter,
+      bench->count);
+  }
+}
+
+
+
+static void cp_BenchmarkConversions(const CPBenchmarkPreset* preset){
+  size_t maxCount = cpBenchmarkConversionCounts[CP_BENCHMARK_CONVERSION_COUNT_COUNT - 1];
+  float* inputData = naMalloc(maxCount * 3 * sizeof(float));
+  float* outData = naMalloc(maxCount * 3 * sizeof(float));
+
+  // Fixed pseudo random input such that every build converts the same values.
+  uint32 seed = 12345;
+  for(size_t i = 0; i < maxCount * 3; ++i){
+    seed = seed * 1664525 + 1013904223;
+    inputData[i] = (float)(seed >> 8) / (float)(1 << 24);
+  }
+
+  CPConversionBenchmark bench;
+  bench.preset = preset;
+  bench.inputData = inputData;
+  bench.outData = outData;
+
+  // Exactly and with the response curve tables. The tables are built in the
+  // unmeasured first run.
+  CPResponseLUT* responseLUT = cpAllocResponseLUT();
+  for(int l = 0; l < 2; ++l){
+    bench.responseLUT = (l == 0) ? NA_NULL : responseLUT;
+    for(size_t t = 0; t < CP_BENCHMARK_COLOR_TYPE_COUNT; ++t){
+      bench.colorType = cpBenchmarkColorTypes[t];
+      bench.normedConverter = cmlGetNormedInputConverter(bench.colorType);
+      for(size_t c = 0; c < CP_BENCHMARK_CONVERSION_COUNT_COUNT; ++c){
+        bench.count = cpBenchmarkConversionCounts[c];
+        cp_RunBenchmarkCase(
+          bench.responseLUT ? "cpFillRGBFloatArrayWithResponseLUT" : "fillRGBFloatArrayWithArray",
+          cmlGetColorTypeString(bench.colorType),
+          preset,
+          bench.count,
+          cp_RunConversionBenchmark,
+          &bench);
+      }
+    }
+  }
+  cpDeallocResponseLUT(responseLUT);
+
+  naFree(outData);
+  naFree(inputData);
+}
+
+
+
+// /////////////////////
+// Machine window
+// /////////////////////
+
+typedef struct CPMachineWindowBenchmark CPMachineWindowBenchmark;
+struct CPMachineWindowBenchmark{
+  const CPBenchmarkPreset* preset;
+  CPColorLUTCache* lutCache;
+  CPResponseLUT* responseLUT;
+  NAByte* rgbaValues;
+};
+
+
+
+static void cp_RunMachineWindowBenchmark(void* data){
+  CPMachineWindowBenchmark* bench = (CPMachineWindowBenchmark*)data;
+  const float normedColorValues[3] = {.5f, .5f, .5f};
+
+  for(size_t w = 0; w < CP_BENCHMARK_WELL_COUNT; ++w){
+    const CPBenchmarkWell* well = &(cpBenchmarkWells[w]);
+    if(well->has2DWell){
+      cpFillColorWell2DRows(
+        bench->rgbaValues,
+        bench->preset->cm,
+        bench->preset->sm,
+        bench->lutCache,
+        bench->responseLUT,
+        0,
+        well->colorType,
+        normedColorValues,
+        well->fixedIndex,
+        CP_BENCHMARK_WELL_SIZE,
+        0,
+        CP_BENCHMARK_WELL_SIZE,
+        NA_TRUE);
+    }
+    // The 1D wells of a controller are converted in one batch, each one
+    // written behind the previous one.
+    size_t channelCount = well->has2DWell ? 3 : 1;
+    NAByte* rgbaValues[3];
+    const size_t variableIndices[3] = {0, 1, 2};
+    for(size_t c = 0; c < channelCount; ++c){
+      rgbaValues[c] = &(bench->rgbaValues[c * CP_BENCHMARK_WELL_SIZE * 4]);
+    }
+    cpFillColorWell1DValuesBatch(
+      rgbaValues,
+      variableIndices,
+      channelCount,
+      bench->preset->cm,
+      bench->preset->sm,
+      bench->lutCache,
+      bench->responseLUT,
+      0,
+      well->colorType,
+      normedColorValues,
+      CP_BENCHMARK_WELL_SIZE,
+      NA_TRUE);
+  }
+}
+
+
+
+static void cp_BenchmarkMachineWindow(const CPBenchmarkPreset* preset){
+  CPMachineWindowBenchmark bench;
+  bench.preset = preset;
+  bench.rgbaValues = naMalloc(CP_BENCHMARK_WELL_SIZE * CP_BENCHMARK_WELL_SIZE * 4);
+
+  size_t elementCount = 0;
+  for(size_t w = 0; w < CP_BENCHMARK_WELL_COUNT; ++w){
+    if(cpBenchmarkWells[w].has2DWell){
+      elementCount += CP_BENCHMARK_WELL_SIZE * CP_BENCHMARK_WELL_SIZE + 3 * CP_BENCHMARK_WELL_SIZE;
+    }else{
+      elementCount += CP_BENCHMARK_WELL_SIZE;
+    }
+  }
+
+  // Without lookup tables, with both table sizes the app offers and with
+  // the response curve tables only. The tables are built in the unmeasured
+  // first run.
+  static const size_t lutGridSizes[4] = {0, 33, 65, 0};
+  for(int i = 0; i < 4; ++i){
+    char variantName[64];
+    bench.responseLUT = NA_NULL;
+    if(i == 3){
+      bench.lutCache = NA_NULL;
+      bench.responseLUT = cpAllocResponseLUT();
+      snprintf(variantName, sizeof(variantName), "allWells/ResponseLUT%d", CP_RESPONSE_LUT_SIZE);
+    }else if(lutGridSizes[i] == 0){
+      bench.lutCache = NA_NULL;
+      snprintf(variantName, sizeof(variantName), "allWells");
+    }else{
+      bench.lutCache = cpAllocColorLUTCache(lutGridSizes[i]);
+      snprintf(variantName, sizeof(variantName), "allWells/LUT%d", (int)lutGridSizes[i]);
+    }
+    cp_RunBenchmarkCase(
+      "cpUpdateMachineWindowController",
+      variantName,
+      preset,
+      elementCount,
+      cp_RunMachineWindowBenchmark,
+      &bench);
+    if(bench.lutCache){
+      cpDeallocColorLUTCache(bench.lutCache);
+    }
+    if(bench.responseLUT){
+      cpDeallocResponseLUT(bench.responseLUT);
+    }
+  }
+
+  naFree(bench.rgbaValues);
+}
+
+
+
+// /////////////////////
+// 3D gamut
+// /////////////////////
+
+typedef struct CPThreeDeeBenchmark CPThreeDeeBenchmark;
+struct CPThreeDeeBenchmark{
+  const CPBenchmarkPreset* preset;
+  CPThreeDeeMesh* mesh;
+  CoordSysType coordSysType;
+  NAInt steps3D;
+  NABool withPointCloud;
+  size_t generation;
+  CMLNormedConverter normedInputConverter;
+  CMLColorConverter coordConverter;
+  CMLNormedConverter normedCoordConverter;
+  NAInt hueIndex;
+};
+
+
+
+// Same mapping as in the 3D window.
+static CMLColorType cp_GetBenchmarkCoordSpace(
+  CoordSysType coordSysType,
+  CMLNormedConverter* normedCoordConverter)
+{
+  CMLColorType coordSpace;
+  switch(coordSysType){
+  case COORD_SYS_HSL:
+  case COORD_SYS_HSL_CARTESIAN: coordSpace = CML_COLOR_HSL; break;
+  case COORD_SYS_HSV:
+  case COORD_SYS_HSV_CARTESIAN: coordSpace = CML_COLOR_HSV; break;
+  case COORD_SYS_Lab: coordSpace = CML_COLOR_Lab; break;
+  case COORD_SYS_Lch_CARTESIAN: coordSpace = CML_COLOR_Lch; break;
+  case COORD_SYS_Luv: coordSpace = CML_COLOR_Luv; break;
+  case COORD_SYS_RGB: coordSpace = CML_COLOR_RGB; break;
+  case COORD_SYS_UVW: coordSpace = CML_COLOR_UVW; break;
+  case COORD_SYS_XYZ: coordSpace = CML_COLOR_XYZ; break;
+  case COORD_SYS_Ycbcr: coordSpace = CML_COLOR_YCbCr; break;
+  case COORD_SYS_Ycd: coordSpace = CML_COLOR_Ycd; break;
+  case COORD_SYS_Yupvp: coordSpace = CML_COLOR_Yupvp; break;
+  case COORD_SYS_Yuv: coordSpace = CML_COLOR_Yuv; break;
+  case COORD_SYS_Yxy: coordSpace = CML_COLOR_Yxy; break;
+  default:
+    #if NA_DEBUG
+      cpError("Unknown coordinate system.");
+    #endif
+    coordSpace = CML_COLOR_XYZ;
+  }
+
+  if(coordSysType == COORD_SYS_HSL || coordSysType == COORD_SYS_HSV){
+    *normedCoordConverter = cmlGetNormedCartesianOutputConverter(coordSpace);
+  }else{
+    *normedCoordConverter = cmlGetNormedOutputConverter(coordSpace);
+  }
+  return coordSpace;
+}
+
+
+
+static void cp_RunThreeDeeBenchmark(void* data){
+  CPThreeDeeBenchmark* bench = (CPThreeDeeBenchmark*)data;
+
+  // A new generation forces the mesh to recompute everything.
+  bench->generation++;
+  cpUpdateThreeDeeMesh(
+    bench->mesh,
+    bench->preset->cm,
+    bench->preset->sm,
+    NA_NULL,
+    NA_NULL,
+    CML_COLOR_RGB,
+    bench->coordSysType,
+    bench->steps3D,
+    bench->generation,
+    bench->withPointCloud,
+    bench->normedInputConverter,
+    bench->coordConverter,
+    bench->normedCoordConverter,
+    bench->hueIndex);
+}
+
+
+
+static void cp_BenchmarkThreeDee(const CPBenchmarkPreset* preset){
+  CPThreeDeeBenchmark bench;
+  bench.preset = preset;
+  bench.mesh = cpAllocThreeDeeMesh();
+  bench.generation = 0;
+  bench.normedInputConverter = cmlGetNormedInputConverter(CML_COLOR_RGB);
+
+  for(int coordSys = 0; coordSys < COORD_SYS_COUNT; ++coordSys){
+    bench.coordSysType = (CoordSysType)coordSys;
+    CMLColorType coordSpace = cp_GetBenchmarkCoordSpace(bench.coordSysType, &(bench.normedCoordConverter));
+    bench.coordConverter = cmlGetColorConverter(coordSpace, CML_COLOR_RGB);
+
+    bench.hueIndex = -1;
+    if((bench.coordSysType == COORD_SYS_HSV_CARTESIAN) || (bench.coordSysType == COORD_SYS_HSL_CARTESIAN)){
+      bench.hueIndex = 0;
+    }else if(bench.coordSysType == COORD_SYS_Lch_CARTESIAN){
+      bench.hueIndex = 2;
+    }
+
+    for(size_t s = 0; s < CP_BENCHMARK_STEPS3D_COUNT; ++s){
+      bench.steps3D = cpBenchmarkSteps3D[s];
+      for(int pointCloud = 0; pointCloud < 2; ++pointCloud){
+        bench.withPointCloud = (NABool)pointCloud;
+
+        // The number of vertices is only known after the first computation.
+        cp_RunThreeDeeBenchmark(&bench);
+        size_t elementCount = cpGetThreeDeeMeshPointCount(bench.mesh);
+        for(size_t i = 0; i < cpGetThreeDeeMeshSurfaceCount(bench.mesh); ++i){
+          elementCount += cpGetThreeDeeMeshSurfaceSteps1(bench.mesh, i) * cpGetThreeDeeMeshSurfaceSteps2(bench.mesh, i);
+        }
+
+        char variantName[64];
+        snprintf(variantName, sizeof(variantName), "%s/%d%s",
+          cpBenchmarkCoordSysNames[coordSys],
+          (int)bench.steps3D,
+          bench.withPointCloud ? "/points" : "");
+        cp_RunBenchmarkCase(
+          "cpUpdateThreeDeeMesh",
+          variantName,
+          preset,
+          elementCount,
+          cp_RunThreeDeeBenchmark,
+          &bench);
+      }
+    }
+  }
+
+  cpDeallocThreeDeeMesh(bench.mesh);
+}
+
+
+
+// /////////////////////
+// Metamerics
+// /////////////////////
+
+typedef struct CPMetamericsBenchmark CPMetamericsBenchmark;
+struct CPMetamericsBenchmark{
+  const CPBenchmarkPreset* preset;
+  CMLFunction* observer10Funcs[3];
+  CMLFunction* observer2Funcs[3];
+  CMLFunction* ref;
+  CPReferenceIlluminationType referenceIlluminationType;
+
+  CPSpectralMatrix* colorRenderingMatrix;
+  CPSpectralMatrix* visMetamericMatrix;
+  CPSpectralMatrix* uvMetamericMatrix;
+  CPSpectralWeights* illWeights10;
+  CPSpectralWeights* illWeights2;
+  CPSpectralWeights* refWeights2;
+  CPSpectralWeights* observerWeights10;
+};
+
+
+
+// Everything cpUpdateMetamericsController computes, without the GUI.
+static void cp_RunMetamericsBenchmark(void* data){
+  CPMetamericsBenchmark* bench = (CPMetamericsBenchmark*)data;
+  const CMLColorMachine* cm = bench->preset->cm;
+  const CMLColorMachine* sm = bench->preset->sm;
+  const CMLFunction* illuminationSpec = cmlGetIlluminationSpectrum(cm);
+
+  CPWhitePoints illWhitePoint10 = cpGetWhitePoints(illuminationSpec, cmlGetWhitePointYxy(cm), bench->observer10Funcs);
+  CPWhitePoints illWhitePoint2 = cpGetWhitePoints(illuminationSpec, cmlGetWhitePointYxy(cm), bench->observer2Funcs);
+  CPWhitePoints refWhitePoint10 = cpGetWhitePoints(bench->ref, NA_NULL, bench->observer10Funcs);
+  CPWhitePoints refWhitePoint2 = cpGetWhitePoints(bench->ref, NA_NULL, bench->observer2Funcs);
+  NA_UNUSED(refWhitePoint10);
+
+  CMLMat33 adaptationMatrix;
+  cp_FillChromaticAdaptationMatrix(adaptationMatrix, sm, illWhitePoint10.Yxy);
+
+  if(!illuminationSpec){
+    return;
+  }
+
+  cpFillSpectralWeights(bench->illWeights10, illuminationSpec, bench->observer10Funcs);
+  cpFillSpectralWeights(bench->illWeights2, illuminationSpec, bench->observer2Funcs);
+  cpFillSpectralWeights(bench->refWeights2, bench->ref, bench->observer2Funcs);
+  cpFillSpectralWeights(bench->observerWeights10, NA_NULL, bench->observer10Funcs);
+
+  CPColorRenderingColors colorRenderingColors = cpComputeColorRenderingColors(
+    0,
+    cm,
+    sm,
+    bench->colorRenderingMatrix,
+    bench->illWeights2,
+    bench->refWeights2,
+    &refWhitePoint2,
+    &illWhitePoint2,
+    bench->ref);
+  CPVisMetamericColors visMetamericColors = cpComputeVisMetamericColors(
+    0,
+    cm,
+    sm,
+    bench->visMetamericMatrix,
+    bench->illWeights10,
+    &illWhitePoint10,
+    adaptationMatrix,
+    bench->referenceIlluminationType);
+  CPUVMetamericColors uvMetamericColors = cpComputeUVMetamericColors(
+    0,
+    cm,
+    sm,
+    bench->uvMetamericMatrix,
+    bench->illWeights10,
+    bench->observerWeights10,
+    &illWhitePoint10,
+    bench->referenceIlluminationType);
+  NA_UNUSED(colorRenderingColors);
+  NA_UNUSED(visMetamericColors);
+  NA_UNUSED(uvMetamericColors);
+}
+
+
+
+static void cp_BenchmarkMetamerics(const CPBenchmarkPreset* preset){
+  static const CMLIlluminationType refTypes[NUMBER_OF_REFERENCE_ILLUMINATIONS] = {
+    CML_ILLUMINATION_D50,
+    CML_ILLUMINATION_D55,
+    CML_ILLUMINATION_D65,
+    CML_ILLUMINATION_D75,
+  };
+
+  // The app retains the observer and reference spectra in its spectral
+  // cache, therefore they are created only once here as well.
+  CPMetamericsBenchmark bench;
+  bench.preset = preset;
+  cmlCreateSpecDistFunctions(bench.observer10Funcs, CML_DEFAULT_10DEG_OBSERVER);
+  cmlCreateSpecDistFunctions(bench.observer2Funcs, CML_DEFAULT_2DEG_OBSERVER);
+  bench.colorRenderingMatrix = cpAllocColorRenderingMatrix();
+  bench.visMetamericMatrix = cpAllocVisMetamericMatrix();
+  bench.uvMetamericMatrix = cpAllocUVMetamericMatrix();
+  bench.illWeights10 = cpAllocSpectralWeights();
+  bench.illWeights2 = cpAllocSpectralWeights();
+  bench.refWeights2 = cpAllocSpectralWeights();
+  bench.observerWeights10 = cpAllocSpectralWeights();
+
+  for(int r = 0; r < NUMBER_OF_REFERENCE_ILLUMINATIONS; ++r){
+    bench.referenceIlluminationType = (CPReferenceIlluminationType)r;
+    bench.ref = cmlCreateIlluminationSpectrum(refTypes[r], 0.f);
+    cp_RunBenchmarkCase(
+      "cpUpdateMetamericsController",
+      cpBenchmarkReferenceNames[r],
+      preset,
+      1,
+      cp_RunMetamericsBenchmark,
+      &bench);
+    cmlReleaseFunction(bench.ref);
+  }
+
+  cpDeallocSpectralWeights(bench.observerWeights10);
+  cpDeallocSpectralWeights(bench.refWeights2);
+  cpDeallocSpectralWeights(bench.illWeights2);
+  cpDeallocSpectralWeights(bench.illWeights10);
+  cpDeallocSpectralMatrix(bench.uvMetamericMatrix);
+  cpDeallocSpectralMatrix(bench.visMetamericMatrix);
+  cpDeallocSpectralMatrix(bench.colorRenderingMatrix);
+  for(int i = 0; i < 3; ++i){
+    cmlReleaseFunction(bench.observer2Funcs[i]);
+    cmlReleaseFunction(bench.observer10Funcs[i]);
+  }
+}
+
+
+
+// /////////////////////
+// Spectral matrix check
+// /////////////////////
+
+// The matrix product sums the lanes in a different order than
+// cmlFilterFunction does. The deviation is measured relative to the Y of the
+// illumination, which is what the metamerics normalize with.
+#define CP_SPECTRAL_MATRIX_TOLERANCE 1e-3f
+
+// Compares the XYZ values of all color rendering remissions computed with
+// the spectral matrix against the integration of CML. Returns NA_TRUE if all
+// deviations are within the tolerance.
+static NABool cp_CheckSpectralMatrix(void){
+  static const CMLIlluminationType refTypes[NUMBER_OF_REFERENCE_ILLUMINATIONS] = {
+    CML_ILLUMINATION_D50,
+    CML_ILLUMINATION_D55,
+    CML_ILLUMINATION_D65,
+    CML_ILLUMINATION_D75,
+  };
+
+  CMLFunction* observerFuncs[3];
+  cmlCreateSpecDistFunctions(observerFuncs, CML_DEFAULT_2DEG_OBSERVER);
+  CPSpectralMatrix* matrix = cpAllocColorRenderingMatrix();
+  CPSpectralWeights* weights = cpAllocSpectralWeights();
+  CMLIntegration integration = cmlMakeDefaultIntegration();
+  NABool passed = NA_TRUE;
+
+  printf(",\n  \"spectralMatrixChecks\": [");
+  for(int r = 0; r < NUMBER_OF_REFERENCE_ILLUMINATIONS; ++r){
+    CMLFunction* illumination = cmlCreateIlluminationSpectrum(refTypes[r], 0.f);
+    cpFillSpectralWeights(weights, illumination, observerFuncs);
+    float whiteY = cmlFilterFunction(illumination, observerFuncs[1], &integration);
+
+    float matrixXYZ[14 * 3];
+    cpMultiplySpectralMatrix(matrixXYZ, matrix, 0, 14, weights);
+
+    float maxDeviation = 0.f;
+    for(size_t i = 0; i < 14; ++i){
+      CMLFunction* remission = cpCreateColorRenderingRemission(i);
+      CMLFunction* remissionIllumination = cmlCreateFunctionMulFunction(remission, illumination);
+      for(int c = 0; c < 3; ++c){
+        float integrated = cmlFilterFunction(remissionIllumination, observerFuncs[c], &integration);
+        float deviation = fabsf(matrixXYZ[i * 3 + c] - integrated) / whiteY;
+        if(deviation > maxDeviation){
+          maxDeviation = deviation;
+        }
+      }
+      cmlReleaseFunction(remissionIllumination);
+      cmlReleaseFunction(remission);
+    }
+    cmlReleaseFunction(illumination);
+
+    NABool illuminationPassed = maxDeviation <= CP_SPECTRAL_MATRIX_TOLERANCE;
+    passed = passed && illuminationPassed;
+    printf(r == 0 ? "\n" : ",\n");
+    printf("    {\"reference\": \"%s\", \"maxRelativeDeviation\": %.3e, \"tolerance\": %.0e, \"passed\": %s}",
+      cpBenchmarkReferenceNames[r],
+      (double)maxDeviation,
+      (double)CP_SPECTRAL_MATRIX_TOLERANCE,
+      illuminationPassed ? "true" : "false");
+  }
+  printf("\n  ]");
+
+  cpDeallocSpectralWeights(weights);
+  cpDeallocSpectralMatrix(matrix);
+  for(int i = 0; i < 3; ++i){
+    cmlReleaseFunction(observerFuncs[i]);
+  }
+  return passed;
+}
+
+
+
+int main(int argc, char** argv){
+  NA_UNUSED(argc);
+  NA_UNUSED(argv);
+
+  naStartRuntime();
+  cpStartupScratchArenas();
+  cpStartupRGBConversion();
+
+  CPBenchmarkPreset presets[3];
+  cp_InitBenchmarkPreset(&(presets[0]), "sRGB/D65", CML_RGB_SRGB, CML_ILLUMINATION_D65, 0.f);
+  cp_InitBenchmarkPreset(&(presets[1]), "AdobeRGB/D50", CML_RGB_ADOBE_98, CML_ILLUMINATION_D50, 0.f);
+  cp_InitBenchmarkPreset(&(presets[2]), "sRGB/D65/Gamma1.8", CML_RGB_SRGB, CML_ILLUMINATION_D65, 1.8f);
+
+  printf("{\n  \"benchmark\": \"ColorPresto\",\n  \"results\": [");
+
+  for(int p = 0; p < 3; ++p){
+    cp_BenchmarkConversions(&(presets[p]));
+    cp_BenchmarkMachineWindow(&(presets[p]));
+    cp_BenchmarkThreeDee(&(presets[p]));
+    cp_BenchmarkMetamerics(&(presets[p]));
+  }
+
+  printf("\n  ]");
+  NABool spectralMatrixPassed = cp_CheckSpectralMatrix();
+  printf(",\n  \"scratchPeakBytes\": %zu\n}\n", cpGetScratchArenaPeakBytes());
+
+  for(int p = 0; p < 3; ++p){
+    cp_ClearBenchmarkPreset(&(presets[p]));
+  }
+
+  cpReleaseThreadScratchArena();
+  cpShutdownRGBConversion();
+  cpShutdownScratchArenas();
+  naStopRuntime();
+  return spectralMatrixPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -3,18 +3,54 @@
 
 #include "CPColorsManager.h"
 #include "CPDesign.h"
+#include "CPSpectralCache.h"
+#include "CPWorkerPool.h"
+#include "Core/CPColorLUT.h"
+#include "Core/CPResponseLUT.h"
+#include "Core/CPScratchArena.h"
+#include "Core/CPSpectralLocus.h"
 #include "About/CPAboutController.h"
 #include "Machine/CPMachineWindowController.h"
 #include "Metamerics/CPMetamericsController.h"
+#include "Preferences/CPPreferences.h"
 #include "Preferences/CPPreferencesController.h"
 #include "ThreeDee/CPThreeDeeController.h"
 
+#include "NAApp/NAApp.h"
 #include "NAUtility/NAMemory.h"
 
+
+
+// Interval in which the main thread checks whether the color wells are done.
+#define CP_UPDATE_POLL_INTERVAL .005
+// Time without a new request after which a preview of the color wells gets
+// refined to the full resolution.
+#define CP_WELL_REFINEMENT_DELAY .02
+
+// The inputs each of the outputs depends on. The metamerics use their own
+// observers and only display the illumination relative to the screen. The 3D
+// view shows the gamut of the machine but not the current color. Its Gray
+// point cloud depends on the gray computation, hence a gray change bumps the
+// machine generation as well. The color controllers show the current color
+// in every color space.
+#define CP_METAMERICS_DEPENDENCIES   (CP_CHANGE_OBSERVER | CP_CHANGE_ILLUMINATION | CP_CHANGE_SCREEN)
+#define CP_THREEDEE_DEPENDENCIES     (CP_CHANGE_MACHINE)
+#define CP_MACHINE_UI_DEPENDENCIES   (CP_CHANGE_MACHINE)
+
 struct CPColorPrestoApplication{
   CMLColorMachine* cm; // current ColorMachine
   CMLColorMachine* sm; // current ScreenMachine
   CPColorsManager* colorsManager;
+  size_t machineGeneration; // increases whenever cm or sm changes
+  CPColorLUTCache* colorLUTCache; // Null if the colors are converted exactly
+  CPResponseLUT* responseLUT; // Null if the response curves are evaluated exactly
+  CPSpectralLocus* cmSpectralLocus;
+  CPWorkerPool* workerPool;
+  NABool updateScheduled; // an update is waiting to be started
+  uint32 pendingChanges;  // inputs changed since the last update started
+  NABool updateRunning;   // the color wells are being computed in the pool
+  NABool wellPreview;     // the color wells are computed coarsely
+  NABool refinementPending; // the preview is shown and awaits refinement
 
   CPMachineWindowController* machineWindowController;
   CPMetamericsController* metamericsController;
@@ -25,12 +61,43 @@ struct CPColorPrestoApplication{
 
 
 
+// The LUTs are optional and selected in the preferences. They are kept until
+// the selection changes and rebuilt whenever the machine generation changes.
+static CPColorLUTCache* cp_AllocPreferredColorLUTCache(void){
+  switch(cpGetPrefsColorLUTSelect()){
+  case ColorLUT33: return cpAllocColorLUTCache(33);
+  case ColorLUT65: return cpAllocColorLUTCache(65);
+  default: return NA_NULL;
+  }
+}
+
+static CPResponseLUT* cp_AllocPreferredResponseLUT(void){
+  return (cpGetPrefsResponseLUTSelect() == ResponseLUT4096)
+    ? cpAllocResponseLUT()
+    : NA_NULL;
+}
+
+
+
 void cpStartupColorPrestoApplication(){
   app = naAlloc(CPColorPrestoApplication);
   
   app->cm = cmlCreateColorMachine();
   app->sm = cmlCreateColorMachine();
   app->colorsManager = cpAllocColorsController();
+  app->machineGeneration = 0;
+  app->colorLUTCache = cp_AllocPreferredColorLUTCache();
+  app->responseLUT = cp_AllocPreferredResponseLUT();
+  app->cmSpectralLocus = cpAllocSpectralLocus();
+  cpStartupScratchArenas();
+  cpStartupRGBConversion();
+  app->workerPool = cpAllocWorkerPool();
+  cpStartupSpectralCache();
+  app->updateScheduled = NA_FALSE;
+  app->pendingChanges = CP_CHANGE_ALL;
+  app->updateRunning = NA_FALSE;
+  app->wellPreview = NA_FALSE;
+  app->refinementPending = NA_FALSE;
 }
 
 
@@ -51,6 +118,8 @@ void cpStartupColorPrestoApplicationUI(){
 
 
 void cpShutdownColorPrestoApplication(){
+  cpCancelUpdates();
+
   if(app->threeDeeController) {
     cpDeallocThreeDeeController(app->threeDeeController);
   }
@@ -67,6 +136,18 @@ void cpShutdownColorPrestoApplication(){
 
   cpShutdownDesign();
 
+  cpShutdownSpectralCache();
+  cpDeallocWorkerPool(app->workerPool);
+  cpReleaseThreadScratchArena();
+  cpShutdownRGBConversion();
+  cpShutdownScratchArenas();
+  if(app->colorLUTCache){
+    cpDeallocColorLUTCache(app->colorLUTCache);
+  }
+  if(app->responseLUT){
+    cpDeallocResponseLUT(app->responseLUT);
+  }
+  cpDeallocSpectralLocus(app->cmSpectralLocus);
   cpDeallocColorsController(app->colorsManager);
   cmlReleaseColorMachine(app->sm);
   cmlReleaseColorMachine(app->cm);
@@ -81,18 +162,46 @@ CMLColorMachine* cpGetCurrentColorMachine(){
 }
 
 void cpResetColorMachine(){
+  cpCancelUpdates();
   cmlReleaseColorMachine(app->cm);
   app->cm = cmlCreateColorMachine();
+  app->machineGeneration++;
+  cpInvalidateColorsManagerCanonicalColor(app->colorsManager);
 }
 
 CMLColorMachine* cpGetCurrentScreenMachine(){
   return app->sm;
 }
 
+size_t cpGetColorMachineGeneration(){
+  return app->machineGeneration;
+}
+
 CPColorsManager* cpGetColorsManager(){
   return app->colorsManager;
 }
 
+CPWorkerPool* cpGetWorkerPool(){
+  return app->workerPool;
+}
+
+CPColorLUTCache* cpGetColorLUTCache(){
+  return app->colorLUTCache;
+}
+
+CPResponseLUT* cpGetResponseLUT(){
+  return app->responseLUT;
+}
+
+CPSpectralLocus* cpGetColorMachineSpectralLocus(){
+  cpUpdateSpectralLocus(app->cmSpectralLocus, app->cm, app->machineGeneration);
+  return app->cmSpectralLocus;
+}
+
+NABool cpIsComputingColorWellPreview(){
+  return app->wellPreview;
+}
+
 
 
 void cpShowMetamerics(){
@@ -156,31 +265,140 @@ void cpShowPreferences(){
 
 
 
+static void cp_AwaitUpdate(void* data){
+  NA_UNUSED(data);
+  if(!app->updateRunning){
+    // The update has been cancelled.
+    return;
+  }
+  if(app->refinementPending){
+    // Nothing has been requested since the preview has been shown. Now, the
+    // wells get computed in full resolution.
+    app->refinementPending = NA_FALSE;
+    cpComputeMachineWindowController(app->machineWindowController, app->workerPool, NA_FALSE);
+    naCallApplicationFunctionInSeconds(cp_AwaitUpdate, NA_NULL, CP_UPDATE_POLL_INTERVAL);
+    return;
+  }
+  if(cpIsWorkerPoolBusy(app->workerPool)){
+    naCallApplicationFunctionInSeconds(cp_AwaitUpdate, NA_NULL, CP_UPDATE_POLL_INTERVAL);
+    return;
+  }
+
+  app->updateRunning = NA_FALSE;
+  cpUpdateMachineWindowController(app->machineWindowController);
+
+  // The update stays running until the preview has been refined. A new
+  // request in the meantime cancels the refinement.
+  if(app->wellPreview){
+    app->wellPreview = NA_FALSE;
+    app->refinementPending = NA_TRUE;
+    app->updateRunning = NA_TRUE;
+    naCallApplicationFunctionInSeconds(cp_AwaitUpdate, NA_NULL, CP_WELL_REFINEMENT_DELAY);
+  }
+}
+
+
+
+static void cp_StartUpdate(void* data){
+  NA_UNUSED(data);
+  uint32 changes = app->pendingChanges;
+  app->updateScheduled = NA_FALSE;
+  app->pendingChanges = 0;
+  app->wellPreview = cpGetPrefsProgressiveWellsSelect() == ProgressiveWellsOn;
+
+  cpComputeMachineWindowController(
+    app->machineWindowController,
+    app->workerPool,
+    (changes & CP_MACHINE_UI_DEPENDENCIES) != 0);
+  app->updateRunning = NA_TRUE;
+
+  // The other windows are updated on this thread while the pool is working.
+  if(changes & CP_METAMERICS_DEPENDENCIES){
+    cpUpdateMetamerics();
+  }
+  if(changes & CP_THREEDEE_DEPENDENCIES){
+    cpUpdateThreeDee();
+  }
+
+  cp_AwaitUpdate(NA_NULL);
+}
+
+
+
+// All requests arriving before the update starts are combined into one.
+static void cp_RequestUpdate(uint32 changes){
+  cpCancelUpdates();
+  cpInvalidateColorsManagerCanonicalColor(app->colorsManager);
+  app->pendingChanges |= changes;
+  if(!app->updateScheduled){
+    app->updateScheduled = NA_TRUE;
+    naCallApplicationFunctionInSeconds(cp_StartUpdate, NA_NULL, 0.);
+  }
+}
+
+
+
+void cpCancelUpdates(){
+  if(app->updateRunning){
+    cpCancelWorkerPool(app->workerPool);
+    app->updateRunning = NA_FALSE;
+    app->refinementPending = NA_FALSE;
+  }
+}
+
+
+
 void cpUpdateColor(){
-  cpUpdateMetamerics();
-  cpUpdateThreeDee();
+  cp_RequestUpdate(CP_CHANGE_COLOR);
 }
-void cpUpdateMachine(){
-  cpUpdateMachineWindowController(app->machineWindowController);
-  cpUpdateMetamerics();
-  cpUpdateThreeDee();
+void cpUpdateMachine(uint32 changes){
+  if(changes & CP_THREEDEE_DEPENDENCIES){
+    app->machineGeneration++;
+  }
+  cp_RequestUpdate(changes);
+}
+
+
+
+void cpResetConversionCaches(){
+  // No worker may use the old tables while they are replaced.
+  cpCancelUpdates();
+  if(app->colorLUTCache){
+    cpDeallocColorLUTCache(app->colorLUTCache);
+  }
+  if(app->responseLUT){
+    cpDeallocResponseLUT(app->responseLUT);
+  }
+  app->colorLUTCache = cp_AllocPreferredColorLUTCache();
+  app->responseLUT = cp_AllocPreferredResponseLUT();
+  cpUpdateMachine(CP_CHANGE_MACHINE);
 }
 
 
 
 void cpSetCurrentColorController(const CPColorController* con){
   cpSetColorsManagerCurrentColorController(cpGetColorsManager(), con);
-  cpUpdateMachine();
+  cp_RequestUpdate(CP_CHANGE_COLOR);
 }
 
 const CPColorController* cpGetCurrentColorController(){
   return cpGetColorsManagerCurrentColorController(cpGetColorsManager());
 }
 
+// Spectra are handed out as their XYZ which is integrated only once per
+// change. Other colors are converted from their own values.
 const float* cpGetCurrentColorData(){
+  if(cpGetColorsManagerCurrentColorType(cpGetColorsManager()) == CML_COLOR_SPECTRUM_ILLUMINATION){
+    return cpGetColorsManagerCanonicalXYZ(cpGetColorsManager(), app->cm);
+  }
   return cpGetColorsManagerCurrentColorData(cpGetColorsManager());
 }
 
 CMLColorType cpGetCurrentColorType(){
-  return cpGetColorsManagerCurrentColorType(cpGetColorsManager());
+  CMLColorType colorType = cpGetColorsManagerCurrentColorType(cpGetColorsManager());
+  return (colorType == CML_COLOR_SPECTRUM_ILLUMINATION) ? CML_COLOR_XYZ : colorType;
+}
+
+const float* cpGetCurrentColorYxy(){
+  return cpGetColorsManagerCanonicalYxy(cpGetColorsManager(), app->cm);
 }
@@ -8,7 +8,24 @@ typedef struct CPColorPrestoApplication CPColorPrestoApplication;
 
 extern CPColorPrestoApplication* app;
 
+CP_PROTOTYPE(CPColorLUTCache);
 CP_PROTOTYPE(CPColorsManager);
+CP_PROTOTYPE(CPResponseLUT);
+CP_PROTOTYPE(CPSpectralLocus);
+CP_PROTOTYPE(CPWorkerPool);
+
+// The inputs an update can be requested for. The application only updates the
+// windows and caches which depend on the changed inputs.
+#define CP_CHANGE_COLOR         0x01
+#define CP_CHANGE_OBSERVER      0x02
+#define CP_CHANGE_ILLUMINATION  0x04
+#define CP_CHANGE_RGB_PRIMARIES 0x08
+#define CP_CHANGE_RESPONSE      0x10
+#define CP_CHANGE_LAB           0x20
+#define CP_CHANGE_GRAY          0x40
+#define CP_CHANGE_SCREEN        0x80
+#define CP_CHANGE_MACHINE       (CP_CHANGE_OBSERVER | CP_CHANGE_ILLUMINATION | CP_CHANGE_RGB_PRIMARIES | CP_CHANGE_RESPONSE | CP_CHANGE_LAB | CP_CHANGE_GRAY | CP_CHANGE_SCREEN)
+#define CP_CHANGE_ALL           (CP_CHANGE_COLOR | CP_CHANGE_MACHINE)
 
 
 
@@ -19,7 +36,19 @@ void cpShutdownColorPrestoApplication(void);
 CMLColorMachine* cpGetCurrentColorMachine(void);
 void cpResetColorMachine(void);
 CMLColorMachine* cpGetCurrentScreenMachine(void);
+size_t cpGetColorMachineGeneration(void);
 CPColorsManager* cpGetColorsManager(void);
+CPWorkerPool* cpGetWorkerPool(void);
+// Returns Null if the colors shall be converted without lookup tables.
+CPColorLUTCache* cpGetColorLUTCache(void);
+// Returns Null if the response curves shall be evaluated exactly.
+CPResponseLUT* cpGetResponseLUT(void);
+// Returns the spectral locus of the current color machine, rebuilt if the
+// machine generation has changed since it was last used.
+CPSpectralLocus* cpGetColorMachineSpectralLocus(void);
+// Returns true while the wells are computed in the coarse resolution of a
+// preview which is refined as soon as the user pauses.
+NABool cpIsComputingColorWellPreview(void);
 
 void cpShowMetamerics(void);
 void cpUpdateMetamerics(void);
@@ -31,7 +60,19 @@ void cpShowAbout(void);
 
 void cpShowPreferences(void);
 
+// Updates are asynchronous. The windows get updated shortly after the request
+// and a newer request cancels the computation of an older one. Only the
+// results of the latest request are shown.
 void cpUpdateColor(void);
-void cpUpdateMachine(void);
+// changes is a combination of the CP_CHANGE_ flags.
+void cpUpdateMachine(uint32 changes);
+
+// Replaces the lookup tables by the ones currently selected in the
+// preferences and recomputes everything converted with them.
+void cpResetConversionCaches(void);
+
+// Stops the running computation and waits until no worker accesses the
+// machines any more. Must be called before changing the color machine.
+void cpCancelUpdates(void);
 
 #endif // CP_COLOR_PRESTO_APPLICATION_DEFINED
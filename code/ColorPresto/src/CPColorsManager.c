@@ -1,5 +1,6 @@
 
 #include "ColorControllers/CPColorController.h"
+#include "ColorControllers/CPSpectralColorController.h"
 #include "CPColorsManager.h"
 #include "mainC.h"
 #include "NAUtility/NAMemory.h"
@@ -9,6 +10,11 @@ struct CPColorsManager{
   const void* currentColor;
   CMLColorType currentType;
   const CPColorController* currentController;
+  // XYZ and Yxy of the current color, converted on first request after the
+  // color or the machine has changed.
+  NABool hasCanonicalColor;
+  CMLVec3 canonicalXYZ;
+  CMLVec3 canonicalYxy;
 };
 
 CPColorsManager* cpAllocColorsController(){
@@ -18,6 +24,7 @@ CPColorsManager* cpAllocColorsController(){
   colorsManager->currentColor = &(colorsManager->fallbackColor);
   colorsManager->currentType = CML_COLOR_Gray;
   colorsManager->currentController = NA_NULL;
+  colorsManager->hasCanonicalColor = NA_FALSE;
   
   return colorsManager;
 }
@@ -36,7 +43,17 @@ CMLColorType cpGetColorsManagerCurrentColorType(const CPColorsManager* colorsMan
 
 void cpSetColorsManagerCurrentColorController(CPColorsManager* colorsManager, const CPColorController* con){
   colorsManager->currentController = con;
-  colorsManager->currentColor = cpGetColorControllerColorData(con);
+  colorsManager->hasCanonicalColor = NA_FALSE;
+  if(con
+    && cpGetColorControllerColorType(con) == CML_COLOR_SPECTRUM_ILLUMINATION
+    && cpIsSpectralColorControllerMonochromatic((const CPSpectralColorController*)con)){
+    // The other controllers convert monochromatic colors from their XYZ
+    // instead of integrating a spectrum.
+    colorsManager->currentColor = cpGetSpectralColorControllerMonochromaticXYZ((const CPSpectralColorController*)con);
+    colorsManager->currentType = CML_COLOR_XYZ;
+    return;
+  }
+  colorsManager->currentColor = con ? cpGetColorControllerColorData(con) : NA_NULL;
   if(colorsManager->currentController == NA_NULL || colorsManager->currentColor == NA_NULL){
     colorsManager->currentColor = &(colorsManager->fallbackColor);
     colorsManager->currentType = CML_COLOR_Gray;
@@ -48,3 +65,28 @@ void cpSetColorsManagerCurrentColorController(CPColorsManager* colorsManager, co
 const CPColorController* cpGetColorsManagerCurrentColorController(CPColorsManager* colorsManager){
   return colorsManager->currentController;
 }
+
+void cpInvalidateColorsManagerCanonicalColor(CPColorsManager* colorsManager){
+  colorsManager->hasCanonicalColor = NA_FALSE;
+}
+
+static void cp_UpdateColorsManagerCanonicalColor(CPColorsManager* colorsManager, const CMLColorMachine* cm){
+  if(!colorsManager->hasCanonicalColor){
+    // A spectrum gets integrated here and nowhere else.
+    CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_XYZ, colorsManager->currentType);
+    converter(cm, colorsManager->canonicalXYZ, colorsManager->currentColor, 1);
+    CMLColorConverter yxyConverter = cmlGetColorConverter(CML_COLOR_Yxy, CML_COLOR_XYZ);
+    yxyConverter(cm, colorsManager->canonicalYxy, colorsManager->canonicalXYZ, 1);
+    colorsManager->hasCanonicalColor = NA_TRUE;
+  }
+}
+
+const float* cpGetColorsManagerCanonicalXYZ(CPColorsManager* colorsManager, const CMLColorMachine* cm){
+  cp_UpdateColorsManagerCanonicalColor(colorsManager, cm);
+  return colorsManager->canonicalXYZ;
+}
+
+const float* cpGetColorsManagerCanonicalYxy(CPColorsManager* colorsManager, const CMLColorMachine* cm){
+  cp_UpdateColorsManagerCanonicalColor(colorsManager, cm);
+  return colorsManager->canonicalYxy;
+}
@@ -24,3 +24,17 @@ void cpSetColorsManagerCurrentColorController(
 const CPColorController* cpGetColorsManagerCurrentColorController(
   CPColorsManager* colorsManager);
 
+// The XYZ and Yxy of the current color are converted once and kept until
+// the color or the machine changes, which must be signalled by invalidating
+// them. A spectrum is integrated only once per change that way.
+void cpInvalidateColorsManagerCanonicalColor(
+  CPColorsManager* colorsManager);
+
+const float* cpGetColorsManagerCanonicalXYZ(
+  CPColorsManager* colorsManager,
+  const CMLColorMachine* cm);
+
+const float* cpGetColorsManagerCanonicalYxy(
+  CPColorsManager* colorsManager,
+  const CMLColorMachine* cm);
+
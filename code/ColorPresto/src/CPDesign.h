@@ -60,6 +60,7 @@ static const float greyColor[3] = {.5f, .5f, .5f};
 #define colorWell2DRightMargin 2.
 #define colorWell2DSize 125
 #define colorWell1DSize 125
+#define colorWellPreviewDivisor 4
 #define spectralWellSize 355
 #define colorWell1DMarginLeft 210
 #define colorWell1DHeight 15.
@@ -3,6 +3,7 @@
 
 #include "NAApp/NAApp.h"
 #include "NAVisual/NAColor.h"
+#include <string.h>
 
 void cpDrawBorder(){
   NAColor borderColor;
@@ -21,3 +22,105 @@ void cpDrawBorder(){
   glVertex2d(-1., -1.);
   glEnd();
 }
+
+
+
+#if NA_OS == NA_OS_WINDOWS
+  #ifndef GL_ARRAY_BUFFER
+    #define GL_ARRAY_BUFFER 0x8892
+  #endif
+  #ifndef GL_STATIC_DRAW
+    #define GL_STATIC_DRAW 0x88E4
+  #endif
+  #ifndef GL_STREAM_DRAW
+    #define GL_STREAM_DRAW 0x88E0
+  #endif
+  #ifndef GL_PIXEL_UNPACK_BUFFER
+    #define GL_PIXEL_UNPACK_BUFFER 0x88EC
+  #endif
+
+  typedef void (APIENTRY* CPGenBuffersProc)(GLsizei n, GLuint* buffers);
+  typedef void (APIENTRY* CPBindBufferProc)(GLenum target, GLuint buffer);
+  typedef void (APIENTRY* CPBufferDataProc)(GLenum target, ptrdiff_t size, const void* data, GLenum usage);
+  typedef void (APIENTRY* CPDeleteBuffersProc)(GLsizei n, const GLuint* buffers);
+
+  static CPGenBuffersProc cp_glGenBuffers = NA_NULL;
+  static CPBindBufferProc cp_glBindBuffer = NA_NULL;
+  static CPBufferDataProc cp_glBufferData = NA_NULL;
+  static CPDeleteBuffersProc cp_glDeleteBuffers = NA_NULL;
+#else
+  #define cp_glGenBuffers glGenBuffers
+  #define cp_glBindBuffer glBindBuffer
+  #define cp_glBufferData glBufferData
+  #define cp_glDeleteBuffers glDeleteBuffers
+#endif
+
+NABool cpInitOpenGLBufferObjects(){
+  #if NA_OS == NA_OS_WINDOWS
+    cp_glGenBuffers = (CPGenBuffersProc)wglGetProcAddress("glGenBuffers");
+    cp_glBindBuffer = (CPBindBufferProc)wglGetProcAddress("glBindBuffer");
+    cp_glBufferData = (CPBufferDataProc)wglGetProcAddress("glBufferData");
+    cp_glDeleteBuffers = (CPDeleteBuffersProc)wglGetProcAddress("glDeleteBuffers");
+    return cp_glGenBuffers && cp_glBindBuffer && cp_glBufferData && cp_glDeleteBuffers;
+  #else
+    return NA_TRUE;
+  #endif
+}
+
+unsigned int cpGenOpenGLArrayBuffer(){
+  GLuint buffer;
+  cp_glGenBuffers(1, &buffer);
+  return buffer;
+}
+
+void cpDeleteOpenGLBuffer(unsigned int buffer){
+  GLuint glBuffer = buffer;
+  cp_glDeleteBuffers(1, &glBuffer);
+}
+
+void cpBindOpenGLArrayBuffer(unsigned int buffer){
+  cp_glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void cpFillOpenGLArrayBuffer(const void* data, size_t byteSize){
+  cp_glBufferData(GL_ARRAY_BUFFER, (ptrdiff_t)byteSize, data, GL_STATIC_DRAW);
+}
+
+NABool cpInitOpenGLPixelBufferObjects(){
+  if(!cpInitOpenGLBufferObjects()){
+    return NA_FALSE;
+  }
+  const char* version = (const char*)glGetString(GL_VERSION);
+  if(version && (version[0] > '2' || (version[0] == '2' && version[1] == '.' && version[2] >= '1'))){
+    return NA_TRUE;
+  }
+  const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+  return extensions && strstr(extensions, "GL_ARB_pixel_buffer_object");
+}
+
+unsigned int cpGenOpenGLPixelBuffer(){
+  GLuint buffer;
+  cp_glGenBuffers(1, &buffer);
+  return buffer;
+}
+
+void cpUploadOpenGLTextureRGBA8(unsigned int target, unsigned int pixelBuffer, int width, int height, const NAByte* rgbaValues){
+  const void* pixels = rgbaValues;
+  if(pixelBuffer){
+    // The driver copies the values into the buffer and transfers them to the
+    // texture asynchronously. The pixels are then an offset into the buffer.
+    cp_glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    cp_glBufferData(GL_PIXEL_UNPACK_BUFFER, (ptrdiff_t)width * height * 4, rgbaValues, GL_STREAM_DRAW);
+    pixels = NA_NULL;
+  }
+
+  if(target == GL_TEXTURE_1D){
+    glTexSubImage1D(GL_TEXTURE_1D, 0, 0, width, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  }else{
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  }
+
+  if(pixelBuffer){
+    cp_glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+}
@@ -2,3 +2,37 @@
 #include "mainC.h"
 
 void cpDrawBorder(void);
+
+// OpenGL 1.2, missing in the headers of Windows.
+#ifndef GL_CLAMP_TO_EDGE
+  #define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+// Vertex buffer objects are OpenGL 1.5. On Windows, the functions must be
+// fetched from the driver first. Returns NA_FALSE if they are unavailable.
+// Must be called with the OpenGL context being current.
+NABool cpInitOpenGLBufferObjects(void);
+
+unsigned int cpGenOpenGLArrayBuffer(void);
+// Deletes an array or pixel buffer. Must be called with the OpenGL context
+// of the buffer being current.
+void cpDeleteOpenGLBuffer(unsigned int buffer);
+void cpBindOpenGLArrayBuffer(unsigned int buffer);
+void cpFillOpenGLArrayBuffer(const void* data, size_t byteSize);
+
+// Pixel buffer objects are OpenGL 2.1 or the ARB_pixel_buffer_object
+// extension. Returns NA_FALSE if they are unavailable. Must be called with
+// the OpenGL context being current.
+NABool cpInitOpenGLPixelBufferObjects(void);
+
+unsigned int cpGenOpenGLPixelBuffer(void);
+
+// Replaces the texels of the texture bound to target, which is either
+// GL_TEXTURE_1D or GL_TEXTURE_2D and has been specified with the same size
+// before. The RGBA8 values go through pixelBuffer unless it is 0.
+void cpUploadOpenGLTextureRGBA8(
+  unsigned int target,
+  unsigned int pixelBuffer,
+  int width,
+  int height,
+  const NAByte* rgbaValues);
@@ -0,0 +1,196 @@
+#include "CPSpectralCache.h"
+
+#include "NAUtility/NAMemory.h"
+
+
+
+// The entries are kept in blocks which never move, hence the functions
+// handed out stay where they are when the cache grows.
+#define CP_SPECTRAL_CACHE_BLOCK_SIZE 16
+
+typedef enum{
+  CP_SPECTRAL_ENTRY_UNUSED,
+  CP_SPECTRAL_ENTRY_OBSERVER,
+  CP_SPECTRAL_ENTRY_ILLUMINATION
+} CPSpectralEntryKind;
+
+typedef struct CPSpectralEntry CPSpectralEntry;
+struct CPSpectralEntry{
+  CPSpectralEntryKind kind;
+  int type;
+  float temperature;
+  size_t retainCount;
+  CMLFunction* functions[3];
+};
+
+typedef struct CPSpectralBlock CPSpectralBlock;
+struct CPSpectralBlock{
+  CPSpectralEntry entries[CP_SPECTRAL_CACHE_BLOCK_SIZE];
+  CPSpectralBlock* next;
+};
+
+static CPSpectralBlock* spectralCache = NA_NULL;
+
+
+
+static CPSpectralBlock* cp_AllocSpectralBlock(void){
+  CPSpectralBlock* block = naAlloc(CPSpectralBlock);
+  for(size_t i = 0; i < CP_SPECTRAL_CACHE_BLOCK_SIZE; ++i){
+    block->entries[i].kind = CP_SPECTRAL_ENTRY_UNUSED;
+    block->entries[i].retainCount = 0;
+  }
+  block->next = NA_NULL;
+  return block;
+}
+
+
+
+static void cp_ClearSpectralEntry(CPSpectralEntry* entry){
+  switch(entry->kind){
+  case CP_SPECTRAL_ENTRY_OBSERVER:
+    cmlReleaseFunction(entry->functions[0]);
+    cmlReleaseFunction(entry->functions[1]);
+    cmlReleaseFunction(entry->functions[2]);
+    break;
+  case CP_SPECTRAL_ENTRY_ILLUMINATION:
+    if(entry->functions[0]){
+      cmlReleaseFunction(entry->functions[0]);
+    }
+    break;
+  default:
+    break;
+  }
+  entry->kind = CP_SPECTRAL_ENTRY_UNUSED;
+}
+
+
+
+static CPSpectralEntry* cp_FindSpectralEntry(CPSpectralEntryKind kind, int type, float temperature){
+  for(CPSpectralBlock* block = spectralCache; block; block = block->next){
+    for(size_t i = 0; i < CP_SPECTRAL_CACHE_BLOCK_SIZE; ++i){
+      CPSpectralEntry* entry = &(block->entries[i]);
+      if(entry->kind == kind && entry->type == type && entry->temperature == temperature){
+        return entry;
+      }
+    }
+  }
+  return NA_NULL;
+}
+
+
+
+static CPSpectralEntry* cp_NewSpectralEntry(CPSpectralEntryKind kind, int type, float temperature){
+  CPSpectralEntry* entry = NA_NULL;
+  CPSpectralBlock* lastBlock = NA_NULL;
+  for(CPSpectralBlock* block = spectralCache; block && !entry; block = block->next){
+    for(size_t i = 0; i < CP_SPECTRAL_CACHE_BLOCK_SIZE; ++i){
+      if(block->entries[i].kind == CP_SPECTRAL_ENTRY_UNUSED){
+        entry = &(block->entries[i]);
+        break;
+      }
+    }
+    lastBlock = block;
+  }
+  if(!entry){
+    // Evict the first entry nobody uses right now.
+    for(CPSpectralBlock* block = spectralCache; block && !entry; block = block->next){
+      for(size_t i = 0; i < CP_SPECTRAL_CACHE_BLOCK_SIZE; ++i){
+        if(block->entries[i].retainCount == 0){
+          entry = &(block->entries[i]);
+          cp_ClearSpectralEntry(entry);
+          break;
+        }
+      }
+    }
+  }
+  if(!entry){
+    // All entries are retained: The cache grows by another block.
+    lastBlock->next = cp_AllocSpectralBlock();
+    entry = &(lastBlock->next->entries[0]);
+  }
+
+  entry->kind = kind;
+  entry->type = type;
+  entry->temperature = temperature;
+  entry->retainCount = 0;
+  entry->functions[0] = NA_NULL;
+  entry->functions[1] = NA_NULL;
+  entry->functions[2] = NA_NULL;
+  return entry;
+}
+
+
+
+void cpStartupSpectralCache(){
+  spectralCache = cp_AllocSpectralBlock();
+}
+
+
+
+void cpShutdownSpectralCache(){
+  while(spectralCache){
+    CPSpectralBlock* block = spectralCache;
+    for(size_t i = 0; i < CP_SPECTRAL_CACHE_BLOCK_SIZE; ++i){
+      #if NA_DEBUG
+        if(block->entries[i].retainCount != 0){
+          cpError("Spectral function is still retained.");
+        }
+      #endif
+      cp_ClearSpectralEntry(&(block->entries[i]));
+    }
+    spectralCache = block->next;
+    naFree(block);
+  }
+}
+
+
+
+CMLFunction** cpRetainObserverFunctions(CMLObserverType observerType){
+  CPSpectralEntry* entry = cp_FindSpectralEntry(CP_SPECTRAL_ENTRY_OBSERVER, (int)observerType, 0.f);
+  if(!entry){
+    entry = cp_NewSpectralEntry(CP_SPECTRAL_ENTRY_OBSERVER, (int)observerType, 0.f);
+    cmlCreateSpecDistFunctions(entry->functions, observerType);
+  }
+  entry->retainCount++;
+  return entry->functions;
+}
+
+
+
+void cpReleaseObserverFunctions(CMLObserverType observerType){
+  CPSpectralEntry* entry = cp_FindSpectralEntry(CP_SPECTRAL_ENTRY_OBSERVER, (int)observerType, 0.f);
+  #if NA_DEBUG
+    if(!entry || entry->retainCount == 0){
+      cpError("Observer functions have not been retained.");
+    }
+  #endif
+  if(entry){
+    entry->retainCount--;
+  }
+}
+
+
+
+const CMLFunction* cpRetainIlluminationSpectrum(CMLIlluminationType illuminationType, float temperature){
+  CPSpectralEntry* entry = cp_FindSpectralEntry(CP_SPECTRAL_ENTRY_ILLUMINATION, (int)illuminationType, temperature);
+  if(!entry){
+    entry = cp_NewSpectralEntry(CP_SPECTRAL_ENTRY_ILLUMINATION, (int)illuminationType, temperature);
+    entry->functions[0] = cmlCreateIlluminationSpectrum(illuminationType, temperature);
+  }
+  entry->retainCount++;
+  return entry->functions[0];
+}
+
+
+
+void cpReleaseIlluminationSpectrum(CMLIlluminationType illuminationType, float temperature){
+  CPSpectralEntry* entry = cp_FindSpectralEntry(CP_SPECTRAL_ENTRY_ILLUMINATION, (int)illuminationType, temperature);
+  #if NA_DEBUG
+    if(!entry || entry->retainCount == 0){
+      cpError("Illumination spectrum has not been retained.");
+    }
+  #endif
+  if(entry){
+    entry->retainCount--;
+  }
+}
@@ -0,0 +1,22 @@
+
+#include "mainC.h"
+
+// Process wide cache of the immutable spectral functions of the observers and
+// illuminants. Every function is created only once and stays in the cache
+// until cpShutdownSpectralCache. The cache counts how many users currently
+// retain an entry. Only entries nobody retains get evicted when the cache is
+// full. If all of them are retained, the cache grows instead. The cache must
+// only be used from the main thread.
+
+void cpStartupSpectralCache(void);
+void cpShutdownSpectralCache(void);
+
+// Returns the three spectral distribution functions of the given observer.
+// The functions are owned by the cache and must not be released directly.
+CMLFunction** cpRetainObserverFunctions(CMLObserverType observerType);
+void cpReleaseObserverFunctions(CMLObserverType observerType);
+
+// Returns the spectrum of the given illumination. The temperature is only
+// used for illuminations which depend on it.
+const CMLFunction* cpRetainIlluminationSpectrum(CMLIlluminationType illuminationType, float temperature);
+void cpReleaseIlluminationSpectrum(CMLIlluminationType illuminationType, float temperature);
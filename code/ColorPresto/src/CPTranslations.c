@@ -22,3 +22,12 @@ void initTranslations(){
   #include "../res/ColorPrestoStrings_zho.h"
 }
 
+
+
+const NAUTF8Char* getGrade(float value){
+  if(value <= .25f){return cpTranslate(CPGradeA);}
+  else if(value <= .5f){return cpTranslate(CPGradeB);}
+  else if(value <= 1.f){return cpTranslate(CPGradeC);}
+  else if(value <= 2.f){return cpTranslate(CPGradeD);}
+  return cpTranslate(CPGradeE);
+}
@@ -189,8 +189,29 @@ enum{
   CPPreferencesLanguageBadTranslationTitle,
   CPPreferencesLanguageBadTranslationText,
 
+  // Strings for the rendering preferences
+  CPPreferencesThreeDeeRenderer,
+  CPPreferencesThreeDeeRendererBuffers,
+  CPPreferencesThreeDeeRendererImmediate,
+  CPPreferencesColorLUT,
+  CPPreferencesColorLUTOff,
+  CPPreferencesColorLUT33,
+  CPPreferencesColorLUT65,
+  CPPreferencesResponseLUT,
+  CPPreferencesResponseLUTExact,
+  CPPreferencesResponseLUT4096,
+  CPPreferencesWellDither,
+  CPPreferencesWellDitherOrdered,
+  CPPreferencesWellDitherOff,
+  CPPreferencesProgressiveWells,
+  CPPreferencesProgressiveWellsOn,
+  CPPreferencesProgressiveWellsOff,
+
 };
 
 const NAUTF8Char* cpTranslate(uint32 id);
 void initTranslations(void);
 
+// ISO 3664 2009 Table D.9
+const NAUTF8Char* getGrade(float value);
+
@@ -0,0 +1,345 @@
+
+#include "CPWorkerPool.h"
+
+#include "Core/CPScratchArena.h"
+#include "NAUtility/NAMemory.h"
+#include "NAUtility/NAThreading.h"
+
+#if NA_OS == NA_OS_WINDOWS
+  #include <windows.h>
+#else
+  #include <unistd.h>
+#endif
+
+
+
+// How long idle threads sleep before looking for work again. Wakeups are
+// triggered by the alarms anyway, these are just upper bounds.
+#define CP_WORKER_IDLE_WAIT .1
+#define CP_WORKER_DONE_WAIT .001
+
+typedef struct CPWorkerTask CPWorkerTask;
+struct CPWorkerTask{
+  NAMutator function;
+  void* data;
+};
+
+// Every thread owns a queue. It takes tasks from the back of its own queue
+// and, when that runs empty, steals from the front of the other queues.
+typedef struct CPWorkerQueue CPWorkerQueue;
+struct CPWorkerQueue{
+  NAMutex mutex;
+  CPWorkerTask* tasks;
+  size_t capacity;
+  size_t start;
+  size_t end;
+};
+
+typedef struct CPWorker CPWorker;
+struct CPWorker{
+  CPWorkerPool* pool;
+  size_t index;
+  NAThread thread;
+};
+
+struct CPWorkerPool{
+  size_t threadCount;
+  CPWorker* workers;
+  // One queue per worker. The thread calling cpAwaitWorkerPool has none and
+  // only steals.
+  CPWorkerQueue* queues;
+  size_t nextQueue;
+
+  // Guards the counters and the shutdown flag.
+  NAMutex mutex;
+  size_t queuedCount;
+  size_t pendingCount;
+  NABool cancelled;
+  NABool shuttingDown;
+
+  NAAlarm workAlarm;
+  NAAlarm doneAlarm;
+};
+
+
+
+static size_t cp_GetCoreCount(void){
+  #if NA_OS == NA_OS_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwNumberOfProcessors;
+  #else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+  #endif
+}
+
+
+
+static void cp_InitWorkerQueue(CPWorkerQueue* queue){
+  queue->mutex = naMakeMutex();
+  queue->capacity = 16;
+  queue->tasks = naMalloc(queue->capacity * sizeof(CPWorkerTask));
+  queue->start = 0;
+  queue->end = 0;
+}
+
+
+
+static void cp_ClearWorkerQueue(CPWorkerQueue* queue){
+  naFree(queue->tasks);
+  naClearMutex(queue->mutex);
+}
+
+
+
+static void cp_PushWorkerQueue(CPWorkerQueue* queue, NAMutator function, void* data){
+  naLockMutex(queue->mutex);
+
+  if(queue->start == queue->end){
+    queue->start = 0;
+    queue->end = 0;
+  }
+  if(queue->end == queue->capacity){
+    size_t count = queue->end - queue->start;
+    CPWorkerTask* newTasks = naMalloc(2 * queue->capacity * sizeof(CPWorkerTask));
+    naCopyn(newTasks, &(queue->tasks[queue->start]), count * sizeof(CPWorkerTask));
+    naFree(queue->tasks);
+    queue->tasks = newTasks;
+    queue->capacity *= 2;
+    queue->start = 0;
+    queue->end = count;
+  }
+
+  queue->tasks[queue->end].function = function;
+  queue->tasks[queue->end].data = data;
+  queue->end++;
+
+  naUnlockMutex(queue->mutex);
+}
+
+
+
+static NABool cp_PopWorkerQueue(CPWorkerQueue* queue, CPWorkerTask* task, NABool steal){
+  naLockMutex(queue->mutex);
+  NABool found = queue->start != queue->end;
+  if(found){
+    if(steal){
+      *task = queue->tasks[queue->start];
+      queue->start++;
+    }else{
+      queue->end--;
+      *task = queue->tasks[queue->end];
+    }
+  }
+  naUnlockMutex(queue->mutex);
+  return found;
+}
+
+
+
+// Workers take from their own queue first, starting with queueIndex. With
+// ownsQueue false, all queues are stolen from.
+static NABool cp_RunNextWorkerPoolTask(CPWorkerPool* pool, size_t queueIndex, NABool ownsQueue){
+  size_t queueCount = pool->threadCount;
+  CPWorkerTask task;
+
+  NABool found = ownsQueue && cp_PopWorkerQueue(&(pool->queues[queueIndex]), &task, NA_FALSE);
+  for(size_t i = ownsQueue ? 1 : 0; !found && i < queueCount; ++i){
+    found = cp_PopWorkerQueue(&(pool->queues[(queueIndex + i) % queueCount]), &task, NA_TRUE);
+  }
+  if(!found){
+    return NA_FALSE;
+  }
+
+  naLockMutex(pool->mutex);
+  pool->queuedCount--;
+  NABool moreTasks = pool->queuedCount > 0;
+  naUnlockMutex(pool->mutex);
+
+  // Pass the wakeup on to the next idle thread.
+  if(moreTasks){
+    naTriggerAlarm(pool->workAlarm);
+  }
+
+  task.function(task.data);
+
+  naLockMutex(pool->mutex);
+  pool->pendingCount--;
+  NABool done = pool->pendingCount == 0;
+  naUnlockMutex(pool->mutex);
+
+  if(done){
+    naTriggerAlarm(pool->doneAlarm);
+  }
+  return NA_TRUE;
+}
+
+
+
+static void cp_RunWorker(void* data){
+  CPWorker* worker = (CPWorker*)data;
+  CPWorkerPool* pool = worker->pool;
+  while(1){
+    naLockMutex(pool->mutex);
+    NABool shuttingDown = pool->shuttingDown;
+    naUnlockMutex(pool->mutex);
+    if(shuttingDown){
+      break;
+    }
+    if(!cp_RunNextWorkerPoolTask(pool, worker->index, NA_TRUE)){
+      naAwaitAlarm(pool->workAlarm, CP_WORKER_IDLE_WAIT);
+    }
+  }
+  cpReleaseThreadScratchArena();
+}
+
+
+
+CPWorkerPool* cpAllocWorkerPool(){
+  CPWorkerPool* pool = naAlloc(CPWorkerPool);
+
+  // The updates run asynchronously and the main thread only waits when
+  // cancelling. Hence every core gets a worker.
+  pool->threadCount = cp_GetCoreCount();
+
+  pool->queues = naMalloc(pool->threadCount * sizeof(CPWorkerQueue));
+  for(size_t i = 0; i < pool->threadCount; ++i){
+    cp_InitWorkerQueue(&(pool->queues[i]));
+  }
+  pool->nextQueue = 0;
+
+  pool->mutex = naMakeMutex();
+  pool->queuedCount = 0;
+  pool->pendingCount = 0;
+  pool->cancelled = NA_FALSE;
+  pool->shuttingDown = NA_FALSE;
+
+  pool->workAlarm = naMakeAlarm();
+  pool->doneAlarm = naMakeAlarm();
+
+  pool->workers = naMalloc(pool->threadCount * sizeof(CPWorker));
+  for(size_t i = 0; i < pool->threadCount; ++i){
+    CPWorker* worker = &(pool->workers[i]);
+    worker->pool = pool;
+    worker->index = i;
+    worker->thread = naMakeThread("Color Presto Worker", cp_RunWorker, worker);
+    naRunThread(worker->thread);
+  }
+
+  return pool;
+}
+
+
+
+void cpDeallocWorkerPool(CPWorkerPool* pool){
+  naLockMutex(pool->mutex);
+  pool->shuttingDown = NA_TRUE;
+  naUnlockMutex(pool->mutex);
+
+  for(size_t i = 0; i < pool->threadCount; ++i){
+    naTriggerAlarm(pool->workAlarm);
+  }
+  for(size_t i = 0; i < pool->threadCount; ++i){
+    naAwaitThread(pool->workers[i].thread);
+    naClearThread(pool->workers[i].thread);
+  }
+  naFree(pool->workers);
+
+  naClearAlarm(pool->doneAlarm);
+  naClearAlarm(pool->workAlarm);
+  naClearMutex(pool->mutex);
+
+  for(size_t i = 0; i < pool->threadCount; ++i){
+    cp_ClearWorkerQueue(&(pool->queues[i]));
+  }
+  naFree(pool->queues);
+  naFree(pool);
+}
+
+
+
+size_t cpGetWorkerPoolThreadCount(const CPWorkerPool* pool){
+  return pool->threadCount;
+}
+
+
+
+void cpAddWorkerPoolTask(CPWorkerPool* pool, NAMutator function, void* data){
+  naLockMutex(pool->mutex);
+  pool->queuedCount++;
+  pool->pendingCount++;
+  size_t queueIndex = pool->nextQueue;
+  pool->nextQueue = (pool->nextQueue + 1) % pool->threadCount;
+  naUnlockMutex(pool->mutex);
+
+  // Spread the tasks over all queues. Idle threads steal the rest.
+  cp_PushWorkerQueue(&(pool->queues[queueIndex]), function, data);
+  naTriggerAlarm(pool->workAlarm);
+}
+
+
+
+void cpAwaitWorkerPool(CPWorkerPool* pool){
+  while(cp_RunNextWorkerPoolTask(pool, 0, NA_FALSE)){
+    // The calling thread works as well.
+  }
+
+  while(1){
+    naLockMutex(pool->mutex);
+    NABool done = pool->pendingCount == 0;
+    naUnlockMutex(pool->mutex);
+    if(done){
+      break;
+    }
+    naAwaitAlarm(pool->doneAlarm, CP_WORKER_DONE_WAIT);
+  }
+}
+
+
+
+NABool cpIsWorkerPoolBusy(CPWorkerPool* pool){
+  naLockMutex(pool->mutex);
+  NABool busy = pool->pendingCount > 0;
+  naUnlockMutex(pool->mutex);
+  return busy;
+}
+
+
+
+void cpCancelWorkerPool(CPWorkerPool* pool){
+  naLockMutex(pool->mutex);
+  pool->cancelled = NA_TRUE;
+  naUnlockMutex(pool->mutex);
+
+  // Drop all tasks which have not been started yet.
+  for(size_t i = 0; i < pool->threadCount; ++i){
+    CPWorkerQueue* queue = &(pool->queues[i]);
+    naLockMutex(queue->mutex);
+    size_t droppedCount = queue->end - queue->start;
+    queue->start = 0;
+    queue->end = 0;
+    naUnlockMutex(queue->mutex);
+
+    naLockMutex(pool->mutex);
+    pool->queuedCount -= droppedCount;
+    pool->pendingCount -= droppedCount;
+    naUnlockMutex(pool->mutex);
+  }
+
+  // The running tasks return early as soon as they see the flag.
+  cpAwaitWorkerPool(pool);
+
+  naLockMutex(pool->mutex);
+  pool->cancelled = NA_FALSE;
+  naUnlockMutex(pool->mutex);
+}
+
+
+
+NABool cpIsWorkerPoolCancelled(CPWorkerPool* pool){
+  naLockMutex(pool->mutex);
+  NABool cancelled = pool->cancelled;
+  naUnlockMutex(pool->mutex);
+  return cancelled;
+}
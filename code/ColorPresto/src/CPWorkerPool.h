@@ -0,0 +1,37 @@
+
+#ifndef CP_WORKER_POOL_DEFINED
+#define CP_WORKER_POOL_DEFINED
+
+#include "mainC.h"
+
+CP_PROTOTYPE(CPWorkerPool);
+
+// A fixed set of threads which stays alive for the whole application and
+// runs the tasks handed to it. Tasks are plain NAMutator functions.
+// Every thread has its own queue. New tasks are spread over the queues and
+// threads running out of work steal tasks from the others.
+
+// Creates one worker per core. The thread adding the tasks does not wait for
+// them but polls cpIsWorkerPoolBusy, so it leaves the cores to the workers.
+CPWorkerPool* cpAllocWorkerPool(void);
+void cpDeallocWorkerPool(CPWorkerPool* pool);
+
+size_t cpGetWorkerPoolThreadCount(const CPWorkerPool* pool);
+
+void cpAddWorkerPoolTask(CPWorkerPool* pool, NAMutator function, void* data);
+
+// Steals tasks onto the calling thread until all queues are empty, then waits
+// for the remaining tasks on the workers to finish.
+void cpAwaitWorkerPool(CPWorkerPool* pool);
+
+// Returns true as long as there are queued or running tasks.
+NABool cpIsWorkerPoolBusy(CPWorkerPool* pool);
+
+// Drops all queued tasks and waits for the running ones to return. Long tasks
+// should check cpIsWorkerPoolCancelled every now and then and return early.
+void cpCancelWorkerPool(CPWorkerPool* pool);
+NABool cpIsWorkerPoolCancelled(CPWorkerPool* pool);
+
+
+
+#endif // CP_WORKER_POOL_DEFINED
@@ -92,7 +92,7 @@ void cpSetGrayColorControllerColorData(CPGrayColorController* con, const void* d
 
 
 
-void cpComputeGrayColorController(CPGrayColorController* con) {
+void cpComputeGrayColorController(CPGrayColorController* con, CPWorkerPool* pool) {
   CMLColorMachine* cm = cpGetCurrentColorMachine();
 
   CMLColorType currentColorType = cpGetCurrentColorType();
@@ -100,7 +100,7 @@ void cpComputeGrayColorController(CPGrayColorController* con) {
   CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_Gray, currentColorType);
   converter(cm, &(con->grayColor), currentColorData, 1);
 
-  cpComputeColorWell1D(con->colorWell1DGray);
+  cpAddColorWell1DTask(con->colorWell1DGray, pool);
 }
 
 
@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPGrayColorController CPGrayColorController;
 
@@ -13,7 +14,9 @@ void cpDeallocGrayColorController(CPGrayColorController* con);
 const void* cpGetGrayColorControllerColorData(const CPGrayColorController* con);
 void cpSetGrayColorControllerColorData(CPGrayColorController* con, const void* data);
 
-void cpComputeGrayColorController(CPGrayColorController* con);
+// Converts the current color on the calling thread and adds the computation
+// of the color wells to the pool.
+void cpComputeGrayColorController(CPGrayColorController* con, CPWorkerPool* pool);
 void cpUpdateGrayColorController(CPGrayColorController* con);
 
 
@@ -160,7 +160,7 @@ void cpSetHSVHSLColorControllerColorData(CPHSVHSLColorController* con, const voi
 
 
 
-void cpComputeHSVHSLColorController(CPHSVHSLColorController* con) {
+void cpComputeHSVHSLColorController(CPHSVHSLColorController* con, CPWorkerPool* pool) {
   HSVHSLSelect hsvhslSelect = cpGetPrefsHSVHSLSelect();
   CMLColorType colorType = (hsvhslSelect == HSV) ? CML_COLOR_HSV : CML_COLOR_HSL;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
@@ -170,10 +170,8 @@ void cpComputeHSVHSLColorController(CPHSVHSLColorController* con) {
   CMLColorConverter converter = cmlGetColorConverter(colorType, currentColorType);
   converter(cm, con->color, currentColorData, 1);
 
-  cpComputeColorWell2D(con->colorWell2D);
-  cpComputeColorWell1D(con->colorWell1D0);
-  cpComputeColorWell1D(con->colorWell1D1);
-  cpComputeColorWell1D(con->colorWell1D2);
+  cpAddColorWell2DTasks(con->colorWell2D, pool);
+  cpAddColorWell1DTripleTask(con->colorWell1D0, con->colorWell1D1, con->colorWell1D2, pool);
 }
 
 
@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPHSVHSLColorController CPHSVHSLColorController;
 
@@ -13,6 +14,8 @@ void cpDeallocHSVHSLColorController(CPHSVHSLColorController* con);
 const void* cpGetHSVHSLColorControllerColorData(const CPHSVHSLColorController* con);
 void cpSetHSVHSLColorControllerColorData(CPHSVHSLColorController* con, const void* data);
 
-void cpComputeHSVHSLColorController(CPHSVHSLColorController* con);
+// Converts the current color on the calling thread and adds the computation
+// of the color wells to the pool.
+void cpComputeHSVHSLColorController(CPHSVHSLColorController* con, CPWorkerPool* pool);
 void cpUpdateHSVHSLColorController(CPHSVHSLColorController* con);
 
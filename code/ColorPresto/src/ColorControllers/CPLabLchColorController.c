@@ -158,7 +158,7 @@ void cpSetLabLchColorControllerColorData(CPLabLchColorController* con, const voi
 
 
 
-void cpComputeLabLchColorController(CPLabLchColorController* con) {
+void cpComputeLabLchColorController(CPLabLchColorController* con, CPWorkerPool* pool) {
   LabLchSelect lablchSelect = cpGetPrefsLabLchSelect();
   CMLColorType colorType = (lablchSelect == Lab) ? CML_COLOR_Lab : CML_COLOR_Lch;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
@@ -168,10 +168,8 @@ void cpComputeLabLchColorController(CPLabLchColorController* con) {
   CMLColorConverter converter = cmlGetColorConverter(colorType, currentColorType);
   converter(cm, con->color, currentColorData, 1);
 
-  cpComputeColorWell2D(con->colorWell2D);
-  cpComputeColorWell1D(con->colorWell1D0);
-  cpComputeColorWell1D(con->colorWell1D1);
-  cpComputeColorWell1D(con->colorWell1D2);
+  cpAddColorWell2DTasks(con->colorWell2D, pool);
+  cpAddColorWell1DTripleTask(con->colorWell1D0, con->colorWell1D1, con->colorWell1D2, pool);
 }
 
 
@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPLabLchColorController CPLabLchColorController;
 
@@ -13,6 +14,8 @@ void cpDeallocLabLchColorController(CPLabLchColorController* con);
 const void* cpGetLabLchColorControllerColorData(const CPLabLchColorController* con);
 void cpSetLabLchColorControllerColorData(CPLabLchColorController* con, const void* data);
 
-void cpComputeLabLchColorController(CPLabLchColorController* con);
+// Converts the current color on the calling thread and adds the computation
+// of the color wells to the pool.
+void cpComputeLabLchColorController(CPLabLchColorController* con, CPWorkerPool* pool);
 void cpUpdateLabLchColorController(CPLabLchColorController* con);
 
@@ -159,7 +159,7 @@ void cpSetLuvUVWColorControllerColorData(CPLuvUVWColorController* con, const voi
 
 
 
-void cpComputeLuvUVWColorController(CPLuvUVWColorController* con) {
+void cpComputeLuvUVWColorController(CPLuvUVWColorController* con, CPWorkerPool* pool) {
   LuvUVWSelect luvuvwSelect = cpGetPrefsLuvUVWSelect();
   CMLColorType colorType = (luvuvwSelect == Luv) ? CML_COLOR_Luv : CML_COLOR_UVW;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
@@ -169,10 +169,8 @@ void cpComputeLuvUVWColorController(CPLuvUVWColorController* con) {
   CMLColorConverter converter = cmlGetColorConverter(colorType, currentColorType);
   converter(cm, con->color, currentColorData, 1);
 
-  cpComputeColorWell2D(con->colorWell2D);
-  cpComputeColorWell1D(con->colorWell1D0);
-  cpComputeColorWell1D(con->colorWell1D1);
-  cpComputeColorWell1D(con->colorWell1D2);
+  cpAddColorWell2DTasks(con->colorWell2D, pool);
+  cpAddColorWell1DTripleTask(con->colorWell1D0, con->colorWell1D1, con->colorWell1D2, pool);
 }
 
 
@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPLuvUVWColorController CPLuvUVWColorController;
 
@@ -13,6 +14,8 @@ void cpDeallocLuvUVWColorController(CPLuvUVWColorController* con);
 const void* cpGetLuvUVWColorControllerColorData(const CPLuvUVWColorController* con);
 void cpSetLuvUVWColorControllerColorData(CPLuvUVWColorController* con, const void* data);
 
-void cpComputeLuvUVWColorController(CPLuvUVWColorController* con);
+// Converts the current color on the calling thread and adds the computation
+// of the color wells to the pool.
+void cpComputeLuvUVWColorController(CPLuvUVWColorController* con, CPWorkerPool* pool);
 void cpUpdateLuvUVWColorController(CPLuvUVWColorController* con);
 
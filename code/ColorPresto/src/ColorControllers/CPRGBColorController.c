@@ -155,7 +155,7 @@ void cpSetRGBColorControllerColorData(CPRGBColorController* con, const void* dat
 
 
 
-void cpComputeRGBColorController(CPRGBColorController* con) {
+void cpComputeRGBColorController(CPRGBColorController* con, CPWorkerPool* pool) {
   CMLColorMachine* cm = cpGetCurrentColorMachine();
 
   CMLColorType currentColorType = cpGetCurrentColorType();
@@ -163,10 +163,8 @@ void cpComputeRGBColorController(CPRGBColorController* con) {
   CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_RGB, currentColorType);
   converter(cm, con->rgbColor, currentColorData, 1);
 
-  cpComputeColorWell2D(con->colorWell2D);
-  cpComputeColorWell1D(con->colorWell1DR);
-  cpComputeColorWell1D(con->colorWell1DG);
-  cpComputeColorWell1D(con->colorWell1DB);
+  cpAddColorWell2DTasks(con->colorWell2D, pool);
+  cpAddColorWell1DTripleTask(con->colorWell1DR, con->colorWell1DG, con->colorWell1DB, pool);
 }
 
 
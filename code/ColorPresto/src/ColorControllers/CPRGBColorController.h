@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPRGBColorController CPRGBColorController;
 
@@ -13,6 +14,8 @@ void cpDeallocRGBColorController(CPRGBColorController* con);
 const void* cpGetRGBColorControllerColorData(const CPRGBColorController* con);
 void cpSetRGBColorControllerColorData(CPRGBColorController* con, const void* data);
 
-void cpComputeRGBColorController(CPRGBColorController* con);
+// Converts the current color on the calling thread and adds the computation
+// of the color wells to the pool.
+void cpComputeRGBColorController(CPRGBColorController* con, CPWorkerPool* pool);
 void cpUpdateRGBColorController(CPRGBColorController* con);
 
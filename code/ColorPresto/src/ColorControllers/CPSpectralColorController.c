@@ -10,16 +10,74 @@
 #include "NAApp/NAApp.h"
 #include "NAUtility/NAMemory.h"
 
+// Number of wavelengths in the table of the monochromatic stimuli.
+#define CP_MONOCHROMATIC_COUNT ((size_t)((CML_DEFAULT_INTEGRATION_MAX - CML_DEFAULT_INTEGRATION_MIN) / CML_DEFAULT_INTEGRATION_STEPSIZE) + 1)
+
 struct CPSpectralColorController{
   CPColorController baseController;
   
   CPSpectralColorWell* display;
   
-  CMLFunction* spectralColor;
+  CMLFunction* spectralColor; // Null while the color is monochromatic
+
+  // Colors picked in the well are monochromatic. Their XYZ is interpolated
+  // in a table of the stimuli at every integration step which is built once
+  // per machine generation.
+  NABool isMonochromatic;
+  float lambda;
+  CMLVec3 monochromaticXYZ;
+  float* stimulusXYZ;
+  NABool hasStimulusXYZ;
+  size_t stimulusGeneration;
 };
 
 
 
+// The stimuli are the same the well used to create for every mouse move: A
+// dirac filter divided by the radiometric scale.
+static void cp_UpdateMonochromaticStimuli(CPSpectralColorController* con){
+  size_t machineGeneration = cpGetColorMachineGeneration();
+  if(con->hasStimulusXYZ && con->stimulusGeneration == machineGeneration){
+    return;
+  }
+
+  CMLColorMachine* cm = cpGetCurrentColorMachine();
+  CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_XYZ, CML_COLOR_SPECTRUM_ILLUMINATION);
+  float inverseScale = cmlInverse(cmlGetRadiometricScale(cm));
+  for(size_t i = 0; i < CP_MONOCHROMATIC_COUNT; ++i){
+    float lambda = CML_DEFAULT_INTEGRATION_MIN + (float)i * CML_DEFAULT_INTEGRATION_STEPSIZE;
+    CMLFunction* dirac = cmlCreateDiracFilter(lambda);
+    CMLFunction* illumDirac = cmlCreateFunctionMulScalar(dirac, inverseScale);
+    converter(cm, &(con->stimulusXYZ[i * 3]), illumDirac, 1);
+    cmlReleaseFunction(dirac);
+    cmlReleaseFunction(illumDirac);
+  }
+
+  con->hasStimulusXYZ = NA_TRUE;
+  con->stimulusGeneration = machineGeneration;
+}
+
+
+
+static void cp_InterpolateMonochromaticXYZ(CPSpectralColorController* con){
+  cp_UpdateMonochromaticStimuli(con);
+
+  float index = (con->lambda - CML_DEFAULT_INTEGRATION_MIN) / CML_DEFAULT_INTEGRATION_STEPSIZE;
+  if(index < 0.f){index = 0.f;}
+  if(index > (float)(CP_MONOCHROMATIC_COUNT - 1)){index = (float)(CP_MONOCHROMATIC_COUNT - 1);}
+  size_t i0 = (size_t)index;
+  size_t i1 = (i0 < CP_MONOCHROMATIC_COUNT - 1) ? i0 + 1 : i0;
+  float t = index - (float)i0;
+
+  const float* xyz0 = &(con->stimulusXYZ[i0 * 3]);
+  const float* xyz1 = &(con->stimulusXYZ[i1 * 3]);
+  con->monochromaticXYZ[0] = (1.f - t) * xyz0[0] + t * xyz1[0];
+  con->monochromaticXYZ[1] = (1.f - t) * xyz0[1] + t * xyz1[1];
+  con->monochromaticXYZ[2] = (1.f - t) * xyz0[2] + t * xyz1[2];
+}
+
+
+
 void cp_SpectralValueEdited(NAReaction reaction){
   CPSpectralColorController* con = (CPSpectralColorController*)reaction.controller;
   
@@ -35,6 +93,12 @@ CPSpectralColorController* cpAllocSpectralColorController(void){
   cpInitColorController(&(con->baseController), CML_COLOR_SPECTRUM_ILLUMINATION);
   
   con->spectralColor = cmlCreateConstFilter(0.f);
+  con->isMonochromatic = NA_FALSE;
+  con->lambda = 0.f;
+  cmlSet3(con->monochromaticXYZ, 0.f, 0.f, 0.f);
+  con->stimulusXYZ = naMalloc(CP_MONOCHROMATIC_COUNT * 3 * sizeof(float));
+  con->hasStimulusXYZ = NA_FALSE;
+  con->stimulusGeneration = 0;
   
   con->display = cpAllocSpectralColorWell(&(con->baseController));
   
@@ -49,6 +113,7 @@ CPSpectralColorController* cpAllocSpectralColorController(void){
 
 void cpDeallocSpectralColorController(CPSpectralColorController* con){
   cpDeallocSpectralColorWell(con->display);
+  naFree(con->stimulusXYZ);
   cpClearColorController(&(con->baseController));
   naFree(con);
 }
@@ -62,17 +127,56 @@ const void* cpGetSpectralColorControllerColorData(const CPSpectralColorControlle
 
 
 void cpSetSpectralColorControllerColorData(CPSpectralColorController* con, const void* data){
-  cmlReleaseFunction(con->spectralColor);
+  if(con->spectralColor){
+    cmlReleaseFunction(con->spectralColor);
+  }
   con->spectralColor = cmlDuplicateFunction((CMLFunction*)data);
+  con->isMonochromatic = NA_FALSE;
 }
 
 
 
-void cpComputeSpectralColorController(CPSpectralColorController* con) {
-  CMLColorType currentColorType = cpGetCurrentColorType();
-  if (currentColorType != CML_COLOR_SPECTRUM_ILLUMINATION) {
+void cpSetSpectralColorControllerMonochromatic(CPSpectralColorController* con, float lambda){
+  if(con->spectralColor){
     cmlReleaseFunction(con->spectralColor);
+    con->spectralColor = NA_NULL;
+  }
+  con->isMonochromatic = NA_TRUE;
+  con->lambda = lambda;
+  cp_InterpolateMonochromaticXYZ(con);
+}
+
+
+
+NABool cpIsSpectralColorControllerMonochromatic(const CPSpectralColorController* con){
+  return con->isMonochromatic;
+}
+
+
+
+float cpGetSpectralColorControllerLambda(const CPSpectralColorController* con){
+  return con->lambda;
+}
+
+
+
+const float* cpGetSpectralColorControllerMonochromaticXYZ(const CPSpectralColorController* con){
+  return con->monochromaticXYZ;
+}
+
+
+
+void cpComputeSpectralColorController(CPSpectralColorController* con, CPWorkerPool* pool) {
+  NA_UNUSED(pool);
+  if (cpGetCurrentColorController() != &(con->baseController)) {
+    if(con->spectralColor){
+      cmlReleaseFunction(con->spectralColor);
+    }
     con->spectralColor = cmlCreateConstFilter(0.f);
+    con->isMonochromatic = NA_FALSE;
+  }else if(con->isMonochromatic){
+    // The other controllers read the XYZ which depends on the machine.
+    cp_InterpolateMonochromaticXYZ(con);
   }
 }
 
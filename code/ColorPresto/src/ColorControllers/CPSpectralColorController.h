@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPSpectralColorController CPSpectralColorController;
 
@@ -13,5 +14,16 @@ void cpDeallocSpectralColorController(CPSpectralColorController* con);
 const void* cpGetSpectralColorControllerColorData(const CPSpectralColorController* con);
 void cpSetSpectralColorControllerColorData(CPSpectralColorController* con, const void* data);
 
-void cpComputeSpectralColorController(CPSpectralColorController* con);
+// Sets the color to the monochromatic stimulus of the given wavelength. Its
+// XYZ is looked up in a table, no spectrum gets created. The color data is
+// Null as long as the color is monochromatic, the other controllers read
+// the XYZ instead.
+void cpSetSpectralColorControllerMonochromatic(CPSpectralColorController* con, float lambda);
+NABool cpIsSpectralColorControllerMonochromatic(const CPSpectralColorController* con);
+float cpGetSpectralColorControllerLambda(const CPSpectralColorController* con);
+const float* cpGetSpectralColorControllerMonochromaticXYZ(const CPSpectralColorController* con);
+
+// Has no color wells, the pool is not used. Must be called before the other
+// controllers compute, as it updates the XYZ of a monochromatic color.
+void cpComputeSpectralColorController(CPSpectralColorController* con, CPWorkerPool* pool);
 void cpUpdateSpectralColorController(CPSpectralColorController* con);
@@ -118,7 +118,7 @@ void cpSetXYZColorControllerColorData(CPXYZColorController* con, const void* dat
 
 
 
-void cpComputeXYZColorController(CPXYZColorController* con) {
+void cpComputeXYZColorController(CPXYZColorController* con, CPWorkerPool* pool) {
   CMLColorMachine* cm = cpGetCurrentColorMachine();
   
   CMLColorType currentColorType = cpGetCurrentColorType();
@@ -126,10 +126,8 @@ void cpComputeXYZColorController(CPXYZColorController* con) {
   CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_XYZ, currentColorType);
   converter(cm, con->XYZColor, currentColorData, 1);
   
-  cpComputeColorWell2D(con->colorWell2D);
-  cpComputeColorWell1D(con->colorWell1DX);
-  cpComputeColorWell1D(con->colorWell1DY);
-  cpComputeColorWell1D(con->colorWell1DZ);
+  cpAddColorWell2DTasks(con->colorWell2D, pool);
+  cpAddColorWell1DTripleTask(con->colorWell1DX, con->colorWell1DY, con->colorWell1DZ, pool);
 }
 
 
@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPXYZColorController CPXYZColorController;
 
@@ -13,6 +14,8 @@ void cpDeallocXYZColorController(CPXYZColorController* con);
 const void* cpGetXYZColorControllerColorData(const CPXYZColorController* con);
 void cpSetXYZColorControllerColorData(CPXYZColorController* con, const void* data);
 
-void cpComputeXYZColorController(CPXYZColorController* con);
+// Converts the current color on the calling thread and adds the computation
+// of the color wells to the pool.
+void cpComputeXYZColorController(CPXYZColorController* con, CPWorkerPool* pool);
 void cpUpdateXYZColorController(CPXYZColorController* con);
 
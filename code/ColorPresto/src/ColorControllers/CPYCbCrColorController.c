@@ -118,7 +118,7 @@ void cpSetYCbCrColorControllerColorData(CPYCbCrColorController* con, const void*
 
 
 
-void cpComputeYCbCrColorController(CPYCbCrColorController* con) {
+void cpComputeYCbCrColorController(CPYCbCrColorController* con, CPWorkerPool* pool) {
   CMLColorMachine* cm = cpGetCurrentColorMachine();
 
   CMLColorType currentColorType = cpGetCurrentColorType();
@@ -126,10 +126,8 @@ void cpComputeYCbCrColorController(CPYCbCrColorController* con) {
   CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_YCbCr, currentColorType);
   converter(cm, con->ycbcrColor, currentColorData, 1);
 
-  cpComputeColorWell2D(con->colorWell2D);
-  cpComputeColorWell1D(con->colorWell1DY);
-  cpComputeColorWell1D(con->colorWell1DCb);
-  cpComputeColorWell1D(con->colorWell1DCr);
+  cpAddColorWell2DTasks(con->colorWell2D, pool);
+  cpAddColorWell1DTripleTask(con->colorWell1DY, con->colorWell1DCb, con->colorWell1DCr, pool);
 }
 
 
@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPYCbCrColorController CPYCbCrColorController;
 
@@ -13,6 +14,8 @@ void cpDeallocYCbCrColorController(CPYCbCrColorController* con);
 const void* cpGetYCbCrColorControllerColorData(const CPYCbCrColorController* con);
 void cpSetYCbCrColorControllerColorData(CPYCbCrColorController* con, const void* data);
 
-void cpComputeYCbCrColorController(CPYCbCrColorController* con);
+// Converts the current color on the calling thread and adds the computation
+// of the color wells to the pool.
+void cpComputeYCbCrColorController(CPYCbCrColorController* con, CPWorkerPool* pool);
 void cpUpdateYCbCrColorController(CPYCbCrColorController* con);
 
@@ -159,7 +159,7 @@ void cpSetYuvYupvpColorControllerColorData(CPYuvYupvpColorController* con, const
 
 
 
-void cpComputeYuvYupvpColorController(CPYuvYupvpColorController* con) {
+void cpComputeYuvYupvpColorController(CPYuvYupvpColorController* con, CPWorkerPool* pool) {
   YuvYupvpSelect yuvyupvpSelect = cpGetPrefsYuvYupvpSelect();
   CMLColorType colorType = (yuvyupvpSelect == Yuv) ? CML_COLOR_Yuv : CML_COLOR_Yupvp;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
@@ -169,10 +169,8 @@ void cpComputeYuvYupvpColorController(CPYuvYupvpColorController* con) {
   CMLColorConverter converter = cmlGetColorConverter(colorType, currentColorType);
   converter(cm, con->color, currentColorData, 1);
 
-  cpComputeColorWell2D(con->colorWell2D);
-  cpComputeColorWell1D(con->colorWell1D0);
-  cpComputeColorWell1D(con->colorWell1D1);
-  cpComputeColorWell1D(con->colorWell1D2);
+  cpAddColorWell2DTasks(con->colorWell2D, pool);
+  cpAddColorWell1DTripleTask(con->colorWell1D0, con->colorWell1D1, con->colorWell1D2, pool);
 }
  
  
@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPYuvYupvpColorController CPYuvYupvpColorController;
 
@@ -13,5 +14,7 @@ void cpDeallocYuvYupvpColorController(CPYuvYupvpColorController* con);
 const void* cpGetYuvYupvpColorControllerColorData(const CPYuvYupvpColorController* con);
 void cpSetYuvYupvpColorControllerColorData(CPYuvYupvpColorController* con, const void* data);
 
-void cpComputeYuvYupvpColorController(CPYuvYupvpColorController* con);
+// Converts the current color on the calling thread and adds the computation
+// of the color wells to the pool.
+void cpComputeYuvYupvpColorController(CPYuvYupvpColorController* con, CPWorkerPool* pool);
 void cpUpdateYuvYupvpColorController(CPYuvYupvpColorController* con);
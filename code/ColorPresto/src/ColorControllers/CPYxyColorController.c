@@ -118,7 +118,7 @@ void cpSetYxyColorControllerColorData(CPYxyColorController* con, const void* dat
 
 
 
-void cpComputeYxyColorController(CPYxyColorController* con) {
+void cpComputeYxyColorController(CPYxyColorController* con, CPWorkerPool* pool) {
   CMLColorMachine* cm = cpGetCurrentColorMachine();
 
   CMLColorType currentColorType = cpGetCurrentColorType();
@@ -126,10 +126,8 @@ void cpComputeYxyColorController(CPYxyColorController* con) {
   CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_Yxy, currentColorType);
   converter(cm, con->yxyColor, currentColorData, 1);
 
-  cpComputeColorWell2D(con->colorWell2D);
-  cpComputeColorWell1D(con->colorWell1DY);
-  cpComputeColorWell1D(con->colorWell1Dx);
-  cpComputeColorWell1D(con->colorWell1Dy);
+  cpAddColorWell2DTasks(con->colorWell2D, pool);
+  cpAddColorWell1DTripleTask(con->colorWell1DY, con->colorWell1Dx, con->colorWell1Dy, pool);
 }
 
 
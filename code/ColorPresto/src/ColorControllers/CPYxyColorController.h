@@ -4,6 +4,7 @@
 
 
 CP_PROTOTYPE(NASpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 typedef struct CPYxyColorController CPYxyColorController;
 
@@ -13,6 +14,8 @@ void cpDeallocYxyColorController(CPYxyColorController* con);
 const void* cpGetYxyColorControllerColorData(const CPYxyColorController* con);
 void cpSetYxyColorControllerColorData(CPYxyColorController* con, const void* data);
 
-void cpComputeYxyColorController(CPYxyColorController* con);
+// Converts the current color on the calling thread and adds the computation
+// of the color wells to the pool.
+void cpComputeYxyColorController(CPYxyColorController* con, CPWorkerPool* pool);
 void cpUpdateYxyColorController(CPYxyColorController* con);
 
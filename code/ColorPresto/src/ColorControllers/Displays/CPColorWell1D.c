@@ -4,6 +4,9 @@
 #include "../../CPColorPrestoApplication.h"
 #include "../../CPDesign.h"
 #include "../../CPOpenGLHelper.h"
+#include "../../CPWorkerPool.h"
+#include "../../Core/CPColorWellValues.h"
+#include "../../Preferences/CPPreferences.h"
 #include "../CPColorController.h"
 
 #include "NAApp/NAApp.h"
@@ -11,17 +14,42 @@
 
 
 
+#define CP_WELL1D_MAX_BATCH_COUNT 3
+
 struct CPColorWell1D{
   NAOpenGLSpace* display;
   
   GLuint wellTex;
+  GLuint wellPixelBuffer; // 0 if pixel buffer objects are unavailable
+  size_t textureSize;     // 0 as long as the texture is unspecified
+  size_t uploadedRevision;
   
   CPColorController* colorController;
   const void* colorData;
   size_t variableIndex;
 
-  float* inputValues;
-  float* rgbValues;
+  // Snapshot of the controller taken when the computation is started.
+  CMLColorType colorType;
+  size_t computedSize;
+  CMLVec3 normedColorValues;
+  size_t machineGeneration;
+  NABool dither;
+
+  // The task writes into nextRGBAValues which is swapped with rgbaValues
+  // once the computation has been finished. The capacities are in bytes.
+  NAByte* rgbaValues;
+  NAByte* nextRGBAValues;
+  size_t rgbaSize;
+  size_t nextRGBASize;
+  size_t rgbaCapacity;
+  size_t nextRGBACapacity;
+  NABool hasNextRGBAValues;
+  size_t rgbaRevision;
+
+  // The wells computed by the task of this well, including itself. They
+  // share the color and hence a single conversion.
+  CPColorWell1D* batchWells[CP_WELL1D_MAX_BATCH_COUNT];
+  size_t batchCount;
 };
 
 
@@ -35,8 +63,12 @@ void cmInitColorWell1D(void* data){
   glGenTextures(1, &(well->wellTex));
   glBindTexture(GL_TEXTURE_1D, well->wellTex);
   glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  // The coarse values of a preview get interpolated smoothly.
+  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+
+  well->wellPixelBuffer = cpInitOpenGLPixelBufferObjects() ? cpGenOpenGLPixelBuffer() : 0;
 }
 
 
@@ -84,8 +116,8 @@ void cmDragColorWell1D(NAReaction reaction){
     converter(cm, convertedColorValues, newColorValues, 1);
 
     cpSetColorControllerColorData(well->colorController, convertedColorValues);
+    // Requests the update as well.
     cpSetCurrentColorController(well->colorController);
-    cpUpdateColor();
   }
 }
 
@@ -145,7 +177,16 @@ void cmDrawColorWell1D(NAReaction reaction){
   break;
   }
 
-  glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, colorWell1DSize, 0, GL_RGB, GL_FLOAT, well->rgbValues);
+  // Exposing the window redraws the well without new values.
+  if(well->uploadedRevision != well->rgbaRevision){
+    GLsizei size = (GLsizei)well->rgbaSize;
+    if(well->rgbaSize != well->textureSize){
+      glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NA_NULL);
+      well->textureSize = well->rgbaSize;
+    }
+    cpUploadOpenGLTextureRGBA8(GL_TEXTURE_1D, well->wellPixelBuffer, size, 1, well->rgbaValues);
+    well->uploadedRevision = well->rgbaRevision;
+  }
 
   glEnable(GL_TEXTURE_1D);
   glBegin(GL_TRIANGLE_STRIP);
@@ -193,6 +234,8 @@ void cmDrawColorWell1D(NAReaction reaction){
 
 CPColorWell1D* cpAllocColorWell1D(CPColorController* colorController, const float* colorData, size_t variableIndex){
   CPColorWell1D* well = naAlloc(CPColorWell1D);
+  // Initialized before the OpenGL space which may create its pixel buffer.
+  well->wellPixelBuffer = 0;
   
   well->display = naNewOpenGLSpace(naMakeSize(colorWell1DSize, colorWell1DHeight), cmInitColorWell1D, well);
   naAddUIReaction(well->display, NA_UI_COMMAND_REDRAW, cmDrawColorWell1D, well);
@@ -203,8 +246,17 @@ CPColorWell1D* cpAllocColorWell1D(CPColorController* colorController, const floa
   well->colorData = colorData;
   well->variableIndex = variableIndex;
   
-  well->inputValues = naMalloc(colorWell1DSize * 3 * sizeof(float));
-  well->rgbValues = naMalloc(colorWell2DSize * 3 * sizeof(float));
+  well->textureSize = 0;
+  well->rgbaSize = colorWell1DSize;
+  well->nextRGBASize = colorWell1DSize;
+  well->rgbaCapacity = colorWell1DSize * 4;
+  well->nextRGBACapacity = colorWell1DSize * 4;
+  well->rgbaValues = naMalloc(well->rgbaCapacity);
+  well->nextRGBAValues = naMalloc(well->nextRGBACapacity);
+  well->hasNextRGBAValues = NA_FALSE;
+  well->rgbaRevision = 0;
+  well->uploadedRevision = 0;
+  well->batchCount = 0;
 
   return well;
 }
@@ -212,9 +264,12 @@ CPColorWell1D* cpAllocColorWell1D(CPColorController* colorController, const floa
 
 
 void cpDeallocColorWell1D(CPColorWell1D* well){
-  naFree(well->inputValues);
-  naFree(well->rgbValues);
+  naFree(well->rgbaValues);
+  naFree(well->nextRGBAValues);
   glDeleteTextures(1, &(well->wellTex));
+  if(well->wellPixelBuffer){
+    cpDeleteOpenGLBuffer(well->wellPixelBuffer);
+  }
 }
 
 
@@ -225,68 +280,110 @@ NAOpenGLSpace* cpGetColorWell1DUIElement(CPColorWell1D* well){
 
 
 
-void cpComputeColorWell1D(CPColorWell1D* well){
-  CMLColorMachine* cm = cpGetCurrentColorMachine();
-  CMLColorMachine* sm = cpGetCurrentScreenMachine();
-  CMLColorType colorType = cpGetColorControllerColorType(well->colorController);
-  CMLNormedConverter outputConverter = cmlGetNormedOutputConverter(colorType);
-  CMLNormedConverter inputConverter = cmlGetNormedInputConverter(colorType);
+static void cp_PrepareColorWell1D(CPColorWell1D* well){
+  // Everything the task needs from the controller is read here, on the
+  // calling thread. The controller may change while the task is running.
+  well->colorType = cpGetColorControllerColorType(well->colorController);
+  well->computedSize = cpIsComputingColorWellPreview()
+    ? (colorWell1DSize + colorWellPreviewDivisor - 1) / colorWellPreviewDivisor
+    : (size_t)(colorWell1DSize * naGetUIElementResolutionScale(well->display) + .5);
+  well->machineGeneration = cpGetColorMachineGeneration();
+  well->dither = cpGetPrefsWellDitherSelect() == WellDitherOrdered;
+  CMLNormedConverter outputConverter = cmlGetNormedOutputConverter(well->colorType);
 
-  float* inputPtr = well->inputValues;
-  CMLVec3 normedColorValues = {0.f, 0.f, 0.f};
-  outputConverter(normedColorValues, well->colorData, 1);
+  cmlSet3(well->normedColorValues, 0.f, 0.f, 0.f);
+  outputConverter(well->normedColorValues, well->colorData, 1);
 
-  switch(cmlGetNumChannels(colorType)){
-  case 1:
-    for(int x = 0; x < colorWell1DSize; ++x){
-      float xValue = (float)x / (float)colorWell1DSize;
-      *inputPtr++ = xValue;
-    }
-    break;
+  // No task is running, the buffer can be replaced.
+  if(well->computedSize * 4 > well->nextRGBACapacity){
+    naFree(well->nextRGBAValues);
+    well->nextRGBAValues = naMalloc(well->computedSize * 4);
+    well->nextRGBACapacity = well->computedSize * 4;
+  }
+  well->nextRGBASize = well->computedSize;
+  well->hasNextRGBAValues = NA_TRUE;
+}
 
-  case 3:
-    switch(well->variableIndex){
-    case 0:
-      for(int x = 0; x < colorWell1DSize; ++x){
-        float xValue = (float)x / (float)colorWell1DSize;
-        *inputPtr++ = xValue;
-        *inputPtr++ = normedColorValues[1];
-        *inputPtr++ = normedColorValues[2];
-      }
-      break;
-    case 1:
-      for(int x = 0; x < colorWell1DSize; ++x){
-        float xValue = (float)x / (float)colorWell1DSize;
-        *inputPtr++ = normedColorValues[0];
-        *inputPtr++ = xValue;
-        *inputPtr++ = normedColorValues[2];
-      }
-      break;
-    case 2:
-      for(int x = 0; x < colorWell1DSize; ++x){
-        float xValue = (float)x / (float)colorWell1DSize;
-        *inputPtr++ = normedColorValues[0];
-        *inputPtr++ = normedColorValues[1];
-        *inputPtr++ = xValue;
-      }
-      break;
-    }
-    break;
+
+
+static void cp_ComputeColorWell1DValues(void* data){
+  CPColorWell1D* well = (CPColorWell1D*)data;
+
+  // A newer update supersedes this one.
+  if(cpIsWorkerPoolCancelled(cpGetWorkerPool())){
+    return;
+  }
+
+  // The snapshot of the batched wells only differs in the variable channel.
+  NAByte* rgbaValues[CP_WELL1D_MAX_BATCH_COUNT];
+  size_t variableIndices[CP_WELL1D_MAX_BATCH_COUNT];
+  for(size_t b = 0; b < well->batchCount; ++b){
+    rgbaValues[b] = well->batchWells[b]->nextRGBAValues;
+    variableIndices[b] = well->batchWells[b]->variableIndex;
+  }
+
+  cpFillColorWell1DValuesBatch(
+    rgbaValues,
+    variableIndices,
+    well->batchCount,
+    cpGetCurrentColorMachine(),
+    cpGetCurrentScreenMachine(),
+    cpGetColorLUTCache(),
+    cpGetResponseLUT(),
+    well->machineGeneration,
+    well->colorType,
+    well->normedColorValues,
+    well->computedSize,
+    well->dither);
+}
+
+
+
+// Prepares the given wells and stores them in the batch of the first of
+// them which is returned.
+static CPColorWell1D* cp_PrepareColorWell1DBatch(CPColorWell1D** wells, size_t wellCount){
+  CPColorWell1D* leader = wells[0];
+  for(size_t w = 0; w < wellCount; ++w){
+    cp_PrepareColorWell1D(wells[w]);
+    leader->batchWells[w] = wells[w];
   }
+  leader->batchCount = wellCount;
+  return leader;
+}
+
 
-  // Convert the given values to screen RGBs.
-  fillRGBFloatArrayWithArray(
-    cm,
-    sm,
-    well->rgbValues,
-    well->inputValues,
-    colorType,
-    inputConverter,
-    colorWell1DSize);
+
+void cpAddColorWell1DTask(CPColorWell1D* well, CPWorkerPool* pool){
+  CPColorWell1D* leader = cp_PrepareColorWell1DBatch(&well, 1);
+  cpAddWorkerPoolTask(pool, cp_ComputeColorWell1DValues, leader);
+}
+
+
+
+void cpAddColorWell1DTripleTask(
+  CPColorWell1D* well0,
+  CPColorWell1D* well1,
+  CPColorWell1D* well2,
+  CPWorkerPool* pool)
+{
+  CPColorWell1D* wells[3] = {well0, well1, well2};
+  CPColorWell1D* leader = cp_PrepareColorWell1DBatch(wells, 3);
+  cpAddWorkerPoolTask(pool, cp_ComputeColorWell1DValues, leader);
 }
 
 
 
 void cpUpdateColorWell1D(CPColorWell1D* well){
+  if(well->hasNextRGBAValues){
+    NAByte* tmp = well->rgbaValues;
+    well->rgbaValues = well->nextRGBAValues;
+    well->nextRGBAValues = tmp;
+    size_t tmpCapacity = well->rgbaCapacity;
+    well->rgbaCapacity = well->nextRGBACapacity;
+    well->nextRGBACapacity = tmpCapacity;
+    well->rgbaSize = well->nextRGBASize;
+    well->hasNextRGBAValues = NA_FALSE;
+    well->rgbaRevision++;
+  }
   naRefreshUIElement(well->display, 0.);
 }
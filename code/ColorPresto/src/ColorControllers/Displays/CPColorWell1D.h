@@ -2,6 +2,7 @@
 #include "../../mainC.h"
 
 CP_PROTOTYPE(NAOpenGLSpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 
 
@@ -18,7 +19,15 @@ void cpDeallocColorWell1D(CPColorWell1D* well);
 
 NAOpenGLSpace* cpGetColorWell1DUIElement(CPColorWell1D* well);
 
-void cpComputeColorWell1D(CPColorWell1D* well);
+void cpAddColorWell1DTask(CPColorWell1D* well, CPWorkerPool* pool);
+// Computes the three wells of a controller in a single task which converts
+// all their colors at once. The wells must show the same color.
+void cpAddColorWell1DTripleTask(
+  CPColorWell1D* well0,
+  CPColorWell1D* well1,
+  CPColorWell1D* well2,
+  CPWorkerPool* pool);
+// Shows the newly computed values, if any.
 void cpUpdateColorWell1D(CPColorWell1D* well);
 
 
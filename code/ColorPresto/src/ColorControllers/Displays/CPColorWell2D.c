@@ -4,6 +4,10 @@
 #include "../../CPColorPrestoApplication.h"
 #include "../../CPDesign.h"
 #include "../../CPOpenGLHelper.h"
+#include "../../CPWorkerPool.h"
+#include "../../Core/CPColorWellValues.h"
+#include "../../Core/CPSpectralLocus.h"
+#include "../../Preferences/CPPreferences.h"
 #include "../CPColorController.h"
 
 #include "NAApp/NAApp.h"
@@ -11,16 +15,62 @@
 
 
 
+// The well is computed in blocks of rows which run as separate tasks.
+#define CP_WELL2D_BLOCK_COUNT 5
+// Number of rows converted between two checks for cancellation.
+#define CP_WELL2D_CHUNK_ROWS 2
+
+typedef struct CPColorWell2DBlock CPColorWell2DBlock;
+struct CPColorWell2DBlock{
+  CPColorWell2D* well;
+  int rowStart;
+  int rowCount;
+};
+
+// Everything the values of a well depend on. Dragging within the well only
+// changes the two channels varying along x and y, which keeps the key.
+typedef struct CPColorWell2DKey CPColorWell2DKey;
+struct CPColorWell2DKey{
+  size_t size; // pixels per side
+  CMLColorType colorType;
+  size_t fixedIndex;
+  float fixedValue;
+  size_t machineGeneration;
+  NABool dither;
+};
+
 struct CPColorWell2D{
   NAOpenGLSpace* display;
   
   GLuint wellTex;
+  GLuint wellPixelBuffer; // 0 if pixel buffer objects are unavailable
+  size_t textureSize;     // 0 as long as the texture is unspecified
+  size_t uploadedRevision;
   
   CPColorController* colorController;
   size_t fixedIndex;
 
-  float* inputValues;
-  float* rgbValues;
+  // Snapshot of the controller taken when the computation is started.
+  CMLColorType colorType;
+  size_t computedSize;
+  size_t computedFixedIndex;
+  CMLVec3 normedColorValues;
+  size_t machineGeneration;
+  NABool dither;
+  CPColorWell2DBlock blocks[CP_WELL2D_BLOCK_COUNT];
+
+  // The tasks write into nextRGBAValues which is swapped with rgbaValues
+  // once the whole computation has been finished. The size of the values
+  // is stored in their key, the capacities are in bytes.
+  NAByte* rgbaValues;
+  NAByte* nextRGBAValues;
+  size_t rgbaCapacity;
+  size_t nextRGBACapacity;
+  NABool hasNextRGBAValues;
+  size_t rgbaRevision;
+  CPColorWell2DKey nextKey;
+  CPColorWell2DKey key;
+  NABool hasRGBAValues;
 };
 
 
@@ -34,8 +84,14 @@ void cmInitColorWell2D(void* data){
   glGenTextures(1, &(well->wellTex));
   glBindTexture(GL_TEXTURE_2D, well->wellTex);
   glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  // The coarse values of a preview get interpolated smoothly. The fine ones
+  // have as many texels as the display has pixels.
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  well->wellPixelBuffer = cpInitOpenGLPixelBufferObjects() ? cpGenOpenGLPixelBuffer() : 0;
 }
 
 
@@ -75,8 +131,8 @@ void cmDragColorWell2D(NAReaction reaction){
     clamper(newColorValues, 1);
     
     cpSetColorControllerColorData(well->colorController, newColorValues);
+    // Requests the update as well.
     cpSetCurrentColorController(well->colorController);
-    cpUpdateColor();
   }
 }
 
@@ -121,7 +177,18 @@ void cmDrawColorWell2D(NAReaction reaction){
     break;
   }
 
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, colorWell2DSize, colorWell2DSize, 0, GL_RGB, GL_FLOAT, well->rgbValues);
+  // Exposing the window redraws the well without new values.
+  if(well->uploadedRevision != well->rgbaRevision){
+    GLsizei size = (GLsizei)well->key.size;
+    // The texture is only specified anew when switching between coarse and
+    // fine values. Otherwise, just its texels get replaced.
+    if(well->key.size != well->textureSize){
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NA_NULL);
+      well->textureSize = well->key.size;
+    }
+    cpUploadOpenGLTextureRGBA8(GL_TEXTURE_2D, well->wellPixelBuffer, size, size, well->rgbaValues);
+    well->uploadedRevision = well->rgbaRevision;
+  }
 
   glEnable(GL_TEXTURE_2D);
   glBegin(GL_TRIANGLE_STRIP);
@@ -145,26 +212,21 @@ void cmDrawColorWell2D(NAReaction reaction){
   // Draw the spectrum
   if((colorType == CML_COLOR_Yupvp) || (colorType == CML_COLOR_Yxy)){
     glLineWidth(1);
-    float imin = CML_DEFAULT_INTEGRATION_MIN;
-    float imax = CML_DEFAULT_INTEGRATION_MAX;
-    int32 intervals = (int32)((imax - imin) / CML_DEFAULT_INTEGRATION_STEPSIZE) + 1;
-    
-    CMLColorConverter coordConverter = cmlGetColorConverter(colorType, CML_COLOR_XYZ);
-    CMLNormedConverter normedConverter = cmlGetNormedOutputConverter(colorType);
+    CPSpectralLocus* locus = cpGetColorMachineSpectralLocus();
+    size_t locusCount = cpGetSpectralLocusCount(locus);
+    const float* locusXYZ = cpGetSpectralLocusXYZ(locus);
+    const float* locusRGB = cpGetSpectralLocusRGB(locus);
+    const float* locusNormedCoords = cpGetSpectralLocusNormedCoords(
+      locus,
+      colorType,
+      cmlGetNormedOutputConverter(colorType));
 
     glBegin(GL_LINE_STRIP);
-    for(int32 iStep = 0; iStep <= intervals; iStep++){
-      float l = imin + (((imax - imin) * iStep) / intervals);
-      CMLVec3 curXYZ;
-      cmlGetSpectralXYZColor(cm, curXYZ, l);
-      if(curXYZ[1] > 0.f){
-
-        CMLVec3 curRGB = {0.f, 0.f, 0.f};
-        CMLVec3 curcoords = {0.f, 0.f, 0.f};
-        CMLVec3 curNormedCoords = {0.f, 0.f, 0.f};
-        coordConverter(cm, curcoords, curXYZ, 1);
-        normedConverter(curNormedCoords, curcoords, 1);
-        cmlXYZToRGB(cm, curRGB, curXYZ, 1);
+    for(size_t i = 0; i < locusCount; ++i){
+      if(locusXYZ[i * 3 + 1] > 0.f){
+        CMLVec3 curRGB;
+        cmlCpy3(curRGB, &(locusRGB[i * 3]));
+        const float* curNormedCoords = &(locusNormedCoords[i * 3]);
         cmlMul3(curRGB, .7f);
         cmlClampRGB(curRGB, 1);
         cmlMul3(curRGB, .75f);
@@ -211,6 +273,8 @@ void cmDrawColorWell2D(NAReaction reaction){
 
 CPColorWell2D* cpAllocColorWell2D(CPColorController* colorController, size_t fixedIndex){
   CPColorWell2D* well = naAlloc(CPColorWell2D);
+  // Initialized before the OpenGL space which may create its pixel buffer.
+  well->wellPixelBuffer = 0;
   
   well->display = naNewOpenGLSpace(naMakeSize(colorWell2DSize, colorWell2DSize), cmInitColorWell2D, well);
   naAddUIReaction(well->display, NA_UI_COMMAND_REDRAW, cmDrawColorWell2D, well);
@@ -220,8 +284,19 @@ CPColorWell2D* cpAllocColorWell2D(CPColorController* colorController, size_t fix
   well->colorController = colorController;
   well->fixedIndex = fixedIndex;
 
-  well->inputValues = naMalloc(colorWell2DSize * colorWell2DSize * 3 * sizeof(float));
-  well->rgbValues = naMalloc(colorWell2DSize * colorWell2DSize * 3 * sizeof(float));
+  for(int b = 0; b < CP_WELL2D_BLOCK_COUNT; ++b){
+    well->blocks[b].well = well;
+  }
+
+  well->textureSize = 0;
+  well->rgbaCapacity = colorWell2DSize * colorWell2DSize * 4;
+  well->nextRGBACapacity = colorWell2DSize * colorWell2DSize * 4;
+  well->rgbaValues = naMalloc(well->rgbaCapacity);
+  well->nextRGBAValues = naMalloc(well->nextRGBACapacity);
+  well->hasNextRGBAValues = NA_FALSE;
+  well->rgbaRevision = 0;
+  well->uploadedRevision = 0;
+  well->hasRGBAValues = NA_FALSE;
 
   return well;
 }
@@ -229,9 +304,12 @@ CPColorWell2D* cpAllocColorWell2D(CPColorController* colorController, size_t fix
 
 
 void cpDeallocColorWell2D(CPColorWell2D* well){
-  naFree(well->inputValues);
-  naFree(well->rgbValues);
+  naFree(well->rgbaValues);
+  naFree(well->nextRGBAValues);
   glDeleteTextures(1, &(well->wellTex));
+  if(well->wellPixelBuffer){
+    cpDeleteOpenGLBuffer(well->wellPixelBuffer);
+  }
 }
 
 
@@ -248,66 +326,132 @@ NAOpenGLSpace* cpGetColorWell2DUIElement(CPColorWell2D* well){
 
 
 
-void cpComputeColorWell2D(CPColorWell2D* well) {
+// Compares everything but the size.
+static NABool cp_EqualColorWell2DKeys(const CPColorWell2DKey* key1, const CPColorWell2DKey* key2){
+  return key1->colorType == key2->colorType
+    && key1->fixedIndex == key2->fixedIndex
+    && key1->fixedValue == key2->fixedValue
+    && key1->machineGeneration == key2->machineGeneration
+    && key1->dither == key2->dither;
+}
+
+
+
+// Returns NA_FALSE if the values shown already are the ones which would be
+// computed, at least in the same resolution. A computation cancelled before
+// may then be dropped as well.
+static NABool cp_PrepareColorWell2D(CPColorWell2D* well){
+  // Everything the tasks need from the controller is read here, on the
+  // calling thread. The controller may change while the tasks are running.
+  well->colorType = cpGetColorControllerColorType(well->colorController);
+  well->computedSize = cpIsComputingColorWellPreview()
+    ? (colorWell2DSize + colorWellPreviewDivisor - 1) / colorWellPreviewDivisor
+    : (size_t)(colorWell2DSize * naGetUIElementResolutionScale(well->display) + .5);
+  well->computedFixedIndex = well->fixedIndex;
+  well->machineGeneration = cpGetColorMachineGeneration();
+  well->dither = cpGetPrefsWellDitherSelect() == WellDitherOrdered;
+  CMLNormedConverter outputConverter = cmlGetNormedCartesianOutputConverter(well->colorType);
+
+  cmlSet3(well->normedColorValues, 0.f, 0.f, 0.f);
+  outputConverter(well->normedColorValues, cpGetColorControllerColorData(well->colorController), 1);
+
+  CPColorWell2DKey key;
+  key.size = well->computedSize;
+  key.colorType = well->colorType;
+  key.fixedIndex = well->computedFixedIndex;
+  key.fixedValue = well->normedColorValues[well->computedFixedIndex];
+  key.machineGeneration = well->machineGeneration;
+  key.dither = well->dither;
+
+  if(well->hasRGBAValues && cp_EqualColorWell2DKeys(&key, &(well->key)) && well->key.size >= key.size){
+    well->hasNextRGBAValues = NA_FALSE;
+    return NA_FALSE;
+  }
+
+  // No task is running, the buffer can be replaced.
+  size_t byteSize = key.size * key.size * 4;
+  if(byteSize > well->nextRGBACapacity){
+    naFree(well->nextRGBAValues);
+    well->nextRGBAValues = naMalloc(byteSize);
+    well->nextRGBACapacity = byteSize;
+  }
+
+  size_t blockRows = key.size / CP_WELL2D_BLOCK_COUNT;
+  for(int b = 0; b < CP_WELL2D_BLOCK_COUNT; ++b){
+    well->blocks[b].rowStart = b * (int)blockRows;
+    well->blocks[b].rowCount = (b == CP_WELL2D_BLOCK_COUNT - 1)
+      ? (int)key.size - b * (int)blockRows
+      : (int)blockRows;
+  }
+
+  well->nextKey = key;
+  well->hasNextRGBAValues = NA_TRUE;
+  return NA_TRUE;
+}
+
+
+
+static void cp_ComputeColorWell2DBlock(void* data){
+  CPColorWell2DBlock* block = (CPColorWell2DBlock*)data;
+  CPColorWell2D* well = block->well;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
   CMLColorMachine* sm = cpGetCurrentScreenMachine();
-  CMLColorType colorType = cpGetColorControllerColorType(well->colorController);
-  CMLNormedConverter outputConverter = cmlGetNormedCartesianOutputConverter(colorType);
-  CMLNormedConverter inputConverter = cmlGetNormedCartesianInputConverter(colorType);
+  CPWorkerPool* pool = cpGetWorkerPool();
 
-  float* inputPtr = well->inputValues;
-  CMLVec3 normedColorValues = { 0.f, 0.f, 0.f };
-  outputConverter(normedColorValues, cpGetColorControllerColorData(well->colorController), 1);
-
-  switch (well->fixedIndex) {
-  case 0:
-    for (int y = 0; y < colorWell2DSize; ++y) {
-      float yValue = (float)y / (float)colorWell2DSize;
-      for (int x = 0; x < colorWell2DSize; ++x) {
-        float xValue = (float)x / (float)colorWell2DSize;
-        *inputPtr++ = normedColorValues[0];
-        *inputPtr++ = xValue;
-        *inputPtr++ = yValue;
-      }
-    }
-    break;
-  case 1:
-    for (int y = 0; y < colorWell2DSize; ++y) {
-      float yValue = (float)y / (float)colorWell2DSize;
-      for (int x = 0; x < colorWell2DSize; ++x) {
-        float xValue = (float)x / (float)colorWell2DSize;
-        *inputPtr++ = xValue;
-        *inputPtr++ = normedColorValues[1];
-        *inputPtr++ = yValue;
-      }
+  int rowEnd = block->rowStart + block->rowCount;
+  for(int chunkStart = block->rowStart; chunkStart < rowEnd; chunkStart += CP_WELL2D_CHUNK_ROWS){
+    // A newer update supersedes this one.
+    if(cpIsWorkerPoolCancelled(pool)){
+      return;
     }
-    break;
-  case 2:
-    for (int y = 0; y < colorWell2DSize; ++y) {
-      float yValue = (float)y / (float)colorWell2DSize;
-      for (int x = 0; x < colorWell2DSize; ++x) {
-        float xValue = (float)x / (float)colorWell2DSize;
-        *inputPtr++ = xValue;
-        *inputPtr++ = yValue;
-        *inputPtr++ = normedColorValues[2];
-      }
+
+    int chunkEnd = chunkStart + CP_WELL2D_CHUNK_ROWS;
+    if(chunkEnd > rowEnd){
+      chunkEnd = rowEnd;
     }
-    break;
+
+    cpFillColorWell2DRows(
+      well->nextRGBAValues,
+      cm,
+      sm,
+      cpGetColorLUTCache(),
+      cpGetResponseLUT(),
+      well->machineGeneration,
+      well->colorType,
+      well->normedColorValues,
+      well->computedFixedIndex,
+      well->computedSize,
+      (size_t)chunkStart,
+      (size_t)(chunkEnd - chunkStart),
+      well->dither);
   }
+}
+
+
 
-  // Convert the given values to screen RGBs.
-  fillRGBFloatArrayWithArray(
-    cm,
-    sm,
-    well->rgbValues,
-    well->inputValues,
-    colorType,
-    inputConverter,
-    colorWell2DSize * colorWell2DSize);
+void cpAddColorWell2DTasks(CPColorWell2D* well, CPWorkerPool* pool){
+  if(!cp_PrepareColorWell2D(well)){
+    return;
+  }
+  for(int b = 0; b < CP_WELL2D_BLOCK_COUNT; ++b){
+    cpAddWorkerPoolTask(pool, cp_ComputeColorWell2DBlock, &(well->blocks[b]));
+  }
 }
 
 
 
 void cpUpdateColorWell2D(CPColorWell2D* well){
+  if(well->hasNextRGBAValues){
+    NAByte* tmp = well->rgbaValues;
+    well->rgbaValues = well->nextRGBAValues;
+    well->nextRGBAValues = tmp;
+    size_t tmpCapacity = well->rgbaCapacity;
+    well->rgbaCapacity = well->nextRGBACapacity;
+    well->nextRGBACapacity = tmpCapacity;
+    well->hasNextRGBAValues = NA_FALSE;
+    well->rgbaRevision++;
+    well->key = well->nextKey;
+    well->hasRGBAValues = NA_TRUE;
+  }
   naRefreshUIElement(well->display, 0.);
 }
@@ -2,6 +2,7 @@
 #include "../../mainC.h"
 
 CP_PROTOTYPE(NAOpenGLSpace);
+CP_PROTOTYPE(CPWorkerPool);
 
 
 
@@ -19,7 +20,11 @@ void cpSetColorWell2DFixedIndex(CPColorWell2D* well, size_t fixedIndex);
 
 NAOpenGLSpace* cpGetColorWell2DUIElement(CPColorWell2D* well);
 
-void cpComputeColorWell2D(CPColorWell2D* well);
+// Splits the computation into blocks of rows and adds them to the pool. The
+// current color is read on the calling thread. Nothing is computed if only
+// the channels varying within the well have changed.
+void cpAddColorWell2DTasks(CPColorWell2D* well, CPWorkerPool* pool);
+// Shows the newly computed values, if any.
 void cpUpdateColorWell2D(CPColorWell2D* well);
 
 
@@ -3,24 +3,117 @@
 
 #include "../../CPColorPrestoApplication.h"
 #include "../../CPDesign.h"
+#include "../../CPOpenGLHelper.h"
 #include "../CPColorController.h"
 
 #include "NAApp/NAApp.h"
 #include "NAUtility/NAMemory.h"
+#include <math.h>
 
 
 
+#define CP_GAMMA_STRIPES 10.f
+
+// Everything a response curve of the machine window depends on.
+typedef struct CPGammaCurveKey CPGammaCurveKey;
+struct CPGammaCurveKey{
+  CMLResponseCurveType type;
+  GammaLinearInputParameters params;
+};
+
 struct CPGammaDisplayController{
   NAOpenGLSpace* display;
+  GLuint curveBuffer; // 0 if buffer objects are unavailable
+
+  // The x, y and z of the three curves one after the other, sampleCount
+  // vertices each. A curve is only evaluated anew if its key changes.
+  float* vertices;
+  size_t sampleCount;
+  NABool curveValid[3];
+  CPGammaCurveKey curveKeys[3];
 };
 
 
 
 void cmInitGammaDisplayController(void* data){
+  CPGammaDisplayController* con = (CPGammaDisplayController*)data;
   glEnable(GL_LINE_SMOOTH);
   glEnable(GL_BLEND);
   glEnable(GL_DEPTH_TEST);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  con->curveBuffer = cpInitOpenGLBufferObjects() ? cpGenOpenGLArrayBuffer() : 0;
+}
+
+
+
+static void cp_GetGammaCurveKeys(CPGammaCurveKey* keys, const CMLColorMachine* cm){
+  CMLResponseCurveType types[3];
+  GammaLinearInputParameters params[3];
+  cmlGetRGBResponseTypes(cm, types);
+  cmlGetCustomGammaLinearParametersRGB(cm, params);
+  for(size_t c = 0; c < 3; ++c){
+    keys[c].type = types[c];
+    keys[c].params = params[c];
+  }
+}
+
+
+
+static NABool cp_EqualGammaCurveKeys(const CPGammaCurveKey* key1, const CPGammaCurveKey* key2){
+  return key1->type == key2->type
+    && key1->params.gamma == key2->params.gamma
+    && key1->params.offset == key2->params.offset
+    && key1->params.linScale == key2->params.linScale
+    && key1->params.split == key2->params.split;
+}
+
+
+
+// Evaluates the curves whose keys changed and returns whether any did.
+static NABool cp_UpdateGammaCurves(CPGammaDisplayController* con, const CMLColorMachine* cm, size_t sampleCount){
+  if(sampleCount != con->sampleCount){
+    if(con->vertices){
+      naFree(con->vertices);
+    }
+    con->vertices = naMalloc((sampleCount ? sampleCount : 1) * 3 * 3 * sizeof(float));
+    con->sampleCount = sampleCount;
+    con->curveValid[0] = NA_FALSE;
+    con->curveValid[1] = NA_FALSE;
+    con->curveValid[2] = NA_FALSE;
+  }
+
+  CPGammaCurveKey keys[3];
+  cp_GetGammaCurveKeys(keys, cm);
+  const CMLFunction* (responses[3]) = {0};
+  responses[0] = cmlGetResponseCurveFunc(cmlGetResponseR(cm));
+  responses[1] = cmlGetResponseCurveFunc(cmlGetResponseG(cm));
+  responses[2] = cmlGetResponseCurveFunc(cmlGetResponseB(cm));
+
+  NABool changed = NA_FALSE;
+  for(size_t c = 0; c < 3; ++c){
+    if(con->curveValid[c] && cp_EqualGammaCurveKeys(&(keys[c]), &(con->curveKeys[c]))){
+      continue;
+    }
+    float* vertexPtr = &(con->vertices[c * sampleCount * 3]);
+    for(size_t x = 0; x < sampleCount; ++x){
+      float curX = (float)x / (float)sampleCount;
+      vertexPtr[0] = curX;
+      vertexPtr[1] = cmlEval(responses[c], curX);
+      vertexPtr[2] = sinf(CP_GAMMA_STRIPES * (curX * NA_PI2f + ((float)c / 3.f) * NA_PI2f));
+      vertexPtr += 3;
+    }
+    con->curveKeys[c] = keys[c];
+    con->curveValid[c] = NA_TRUE;
+    changed = NA_TRUE;
+  }
+
+  if(changed && con->curveBuffer){
+    cpBindOpenGLArrayBuffer(con->curveBuffer);
+    cpFillOpenGLArrayBuffer(con->vertices, sampleCount * 3 * 3 * sizeof(float));
+    cpBindOpenGLArrayBuffer(0);
+  }
+  return changed;
 }
 
 
@@ -44,40 +137,28 @@ void cmDrawGammaDisplayController(NAReaction reaction){
   glLoadIdentity();
   glOrtho(0, 1, 0, 1, -1., 1.);
 
-  float stripes = 10.f;
-
-  const CMLFunction* (responses[3]) = {0};
-  responses[0] = cmlGetResponseCurveFunc(cmlGetResponseR(cm));
-  responses[1] = cmlGetResponseCurveFunc(cmlGetResponseG(cm));
-  responses[2] = cmlGetResponseCurveFunc(cmlGetResponseB(cm));
-
-  glBegin(GL_LINE_STRIP);
-    glColor3f(1.f, .5f, .5f);
-    for(uint32 x = 0; x < viewSize.width; ++x){
-      float curX = (float)x / (float)viewSize.width;
-      float y = cmlEval(responses[0], curX);
-      float z = sinf(stripes * (curX * NA_PI2f + (0.f/3.f) * NA_PI2f));
-      glVertex3f(curX, y, z);
-    }
-  glEnd();
-  glBegin(GL_LINE_STRIP);
-    glColor3f(.5f, 1.f, .5f);
-    for(uint32 x = 0; x < viewSize.width; ++x){
-      float curX = (float)x / (float)viewSize.width;
-      float y = cmlEval(responses[1], curX);
-      float z = sinf(stripes * (curX * NA_PI2f + (1.f/3.f) * NA_PI2f));
-      glVertex3f(curX, y, z);
-    }
-  glEnd();
-  glBegin(GL_LINE_STRIP);
-    glColor3f(.5f, .5f, 1.f);
-    for(uint32 x = 0; x < viewSize.width; ++x){
-      float curX = (float)x / (float)viewSize.width;
-      float y = cmlEval(responses[2], curX);
-      float z = sinf(stripes * (curX * NA_PI2f + (2.f/3.f) * NA_PI2f));
-      glVertex3f(curX, y, z);
-    }
-  glEnd();
+  // One sample per point of the view, as many as x < viewSize.width.
+  size_t sampleCount = (size_t)ceil(viewSize.width);
+  cp_UpdateGammaCurves(con, cm, sampleCount);
+
+  // With a bound buffer object, the pointer is an offset into the buffer.
+  const float* base = con->vertices;
+  if(con->curveBuffer){
+    cpBindOpenGLArrayBuffer(con->curveBuffer);
+    base = NA_NULL;
+  }
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 0, base);
+  glColor3f(1.f, .5f, .5f);
+  glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)sampleCount);
+  glColor3f(.5f, 1.f, .5f);
+  glDrawArrays(GL_LINE_STRIP, (GLint)sampleCount, (GLsizei)sampleCount);
+  glColor3f(.5f, .5f, 1.f);
+  glDrawArrays(GL_LINE_STRIP, (GLint)(2 * sampleCount), (GLsizei)sampleCount);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  if(con->curveBuffer){
+    cpBindOpenGLArrayBuffer(0);
+  }
 
   glMatrixMode(GL_PROJECTION);
   glPopMatrix();
@@ -89,6 +170,13 @@ void cmDrawGammaDisplayController(NAReaction reaction){
 
 CPGammaDisplayController* cpAllocGammaDisplayController(){
   CPGammaDisplayController* con = naAlloc(CPGammaDisplayController);
+  // Initialized before the OpenGL space which may create the buffer.
+  con->curveBuffer = 0;
+  con->vertices = NA_NULL;
+  con->sampleCount = 0;
+  con->curveValid[0] = NA_FALSE;
+  con->curveValid[1] = NA_FALSE;
+  con->curveValid[2] = NA_FALSE;
   
   con->display = naNewOpenGLSpace(naMakeSize(gammaDisplaySize, gammaDisplaySize), cmInitGammaDisplayController, con);
   naAddUIReaction(con->display, NA_UI_COMMAND_REDRAW, cmDrawGammaDisplayController, con);
@@ -99,6 +187,12 @@ CPGammaDisplayController* cpAllocGammaDisplayController(){
 
 
 void cpDeallocGammaDisplayController(CPGammaDisplayController* con){
+  if(con->curveBuffer){
+    cpDeleteOpenGLBuffer(con->curveBuffer);
+  }
+  if(con->vertices){
+    naFree(con->vertices);
+  }
 }
 
 
@@ -110,5 +204,13 @@ NAOpenGLSpace* cpGetGammaDisplayControllerUIElement(CPGammaDisplayController* co
 
 
 void cpUpdateGammaDisplayController(CPGammaDisplayController* con){
-  naRefreshUIElement(con->display, 0.);
+  // Most machine changes leave the response curves as they are.
+  CPGammaCurveKey keys[3];
+  cp_GetGammaCurveKeys(keys, cpGetCurrentColorMachine());
+  for(size_t c = 0; c < 3; ++c){
+    if(!con->curveValid[c] || !cp_EqualGammaCurveKeys(&(keys[c]), &(con->curveKeys[c]))){
+      naRefreshUIElement(con->display, 0.);
+      return;
+    }
+  }
 }
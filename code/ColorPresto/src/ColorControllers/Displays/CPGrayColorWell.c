@@ -58,6 +58,7 @@ void cmDrawGrayColorWell(NAReaction reaction){
   
   float colorRGB[3];
   fillRGBFloatArrayWithArray(
+    cpGetColorMachineGeneration(),
     cm,
     sm,
     colorRGB,
@@ -75,6 +76,7 @@ void cmDrawGrayColorWell(NAReaction reaction){
   
   float grayRGB[3];
   fillRGBFloatArrayWithArray(
+    cpGetColorMachineGeneration(),
     cm,
     sm,
     grayRGB,
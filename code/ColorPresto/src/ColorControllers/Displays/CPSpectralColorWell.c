@@ -3,7 +3,9 @@
 
 #include "../../CPColorPrestoApplication.h"
 #include "../../CPDesign.h"
+#include "../../Preferences/CPPreferences.h"
 #include "../CPColorController.h"
+#include "../CPSpectralColorController.h"
 
 #include "NAApp/NAApp.h"
 #include "NAUtility/NAMemory.h"
@@ -15,6 +17,11 @@ struct CPSpectralColorWell{
   NAInt fontId;
 
   GLuint wellTex;
+  // The background depends on the machines and is computed anew whenever
+  // they change.
+  NABool hasBackground;
+  size_t backgroundGeneration;
+  NABool backgroundDither;
 
   CPColorController* colorController;
 };
@@ -25,7 +32,6 @@ void cmDragSpectralColorWell(NAReaction reaction){
   const NAMouseStatus* mouseStatus = naGetCurrentMouseStatus();
   if(naGetMouseButtonPressed(mouseStatus, NA_MOUSE_BUTTON_LEFT)){
     CPSpectralColorWell* well = (CPSpectralColorWell*)reaction.controller;
-    CMLColorMachine* cm = cpGetCurrentColorMachine();
 
     NARect spaceRect = naGetUIElementRectAbsolute(well->openGLSpace);
     double mouseX = (naGetMousePos(mouseStatus).x - spaceRect.pos.x) / spaceRect.size.width;
@@ -34,15 +40,9 @@ void cmDragSpectralColorWell(NAReaction reaction){
 
     float lambda = CML_DEFAULT_INTEGRATION_MIN + (CML_DEFAULT_INTEGRATION_MAX - CML_DEFAULT_INTEGRATION_MIN) * (float)mouseX;
 
-    CMLFunction* dirac = cmlCreateDiracFilter(lambda);
-    CMLFunction* illumDirac = cmlCreateFunctionMulScalar(dirac, cmlInverse(cmlGetRadiometricScale(cm)));
-
-    cpSetColorControllerColorData(well->colorController, illumDirac);
+    cpSetSpectralColorControllerMonochromatic((CPSpectralColorController*)well->colorController, lambda);
+    // Requests the update as well.
     cpSetCurrentColorController(well->colorController);
-    cpUpdateColor();
-
-    cmlReleaseFunction(dirac);
-    cmlReleaseFunction(illumDirac);
   }
 }
 
@@ -59,18 +59,33 @@ void cmInitSpectralColorWell(void* data){
   glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
   glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+}
+
 
-  // Draw the background;
+
+static void cp_FillSpectralColorWellBackground(CPSpectralColorWell* well){
   CMLColorMachine* cm = cpGetCurrentColorMachine();
   CMLColorMachine* sm = cpGetCurrentScreenMachine();
+  size_t machineGeneration = cpGetColorMachineGeneration();
+  NABool dither = cpGetPrefsWellDitherSelect() == WellDitherOrdered;
+  if(well->hasBackground
+    && well->backgroundGeneration == machineGeneration
+    && well->backgroundDither == dither){
+    return;
+  }
 
-  float rgbInputValues[spectralWellSize * 3] = {0};
+  // Every pixel is evaluated at its exact wavelength. As the background is
+  // only computed once per machine generation, this costs nothing per frame.
+  float xyzValues[spectralWellSize * 3];
   for(size_t x = 0; x < spectralWellSize; ++x){
     float lambda = CML_DEFAULT_INTEGRATION_MIN + ((float)x / spectralWellSize) * (CML_DEFAULT_INTEGRATION_MAX - CML_DEFAULT_INTEGRATION_MIN);
-    CMLVec3 xyz;
-    cmlGetSpectralXYZColor(sm, xyz, lambda);
+    cmlGetSpectralXYZColor(sm, &xyzValues[x * 3], lambda);
+  }
+
+  float rgbInputValues[spectralWellSize * 3];
+  cmlXYZToRGB(sm, rgbInputValues, xyzValues, spectralWellSize);
+  for(size_t x = 0; x < spectralWellSize; ++x){
     float* rgbPtr = &rgbInputValues[x * 3];
-    cmlXYZToRGB(sm, rgbPtr, xyz, 1);
     cmlClampRGB(rgbPtr, 1);
     cmlMul3(rgbPtr, .4f);
   }
@@ -79,6 +94,7 @@ void cmInitSpectralColorWell(void* data){
   // Convert the given values to screen RGBs.
   float rgbValues[spectralWellSize * 3];
   fillRGBFloatArrayWithArray(
+    machineGeneration,
     cm,
     sm,
     rgbValues,
@@ -87,7 +103,19 @@ void cmInitSpectralColorWell(void* data){
     cmlGetNormedInputConverter(CML_COLOR_RGB),
     spectralWellSize);
 
-  glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, spectralWellSize, 0, GL_RGB, GL_FLOAT, rgbValues);
+  NAByte rgbaValues[spectralWellSize * 4];
+  cpFillRGBA8ArrayWithRGB(
+    rgbaValues,
+    rgbValues,
+    spectralWellSize,
+    0,
+    1,
+    dither);
+
+  glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, spectralWellSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgbaValues);
+  well->hasBackground = NA_TRUE;
+  well->backgroundGeneration = machineGeneration;
+  well->backgroundDither = dither;
 }
 
 
@@ -108,6 +136,7 @@ void cmDrawSpectralColorWell(NAReaction reaction){
   glClear(GL_DEPTH_BUFFER_BIT);
 
   // Draw the background
+  cp_FillSpectralColorWellBackground(well);
   glEnable(GL_TEXTURE_1D);
   glBegin(GL_TRIANGLE_STRIP);
     glTexCoord2f(0., 0.);
@@ -205,7 +234,16 @@ void cmDrawSpectralColorWell(NAReaction reaction){
   }
 
   // Draw the color
-  if(cpGetColorControllerColorType(well->colorController) == CML_COLOR_SPECTRUM_ILLUMINATION){
+  const CPSpectralColorController* spectralController = (const CPSpectralColorController*)well->colorController;
+  if(cpIsSpectralColorControllerMonochromatic(spectralController)){
+    // Drawn like the dirac filter it stands for.
+    float lambda = cpGetSpectralColorControllerLambda(spectralController);
+    glColor4f(1.f, 1.f, .5f, 1.f);
+    glBegin(GL_LINES);
+      glVertex2f(lambda, viewOffset);
+      glVertex2f(lambda, viewOffset + viewRange);
+    glEnd();
+  }else if(cpGetColorControllerColorType(well->colorController) == CML_COLOR_SPECTRUM_ILLUMINATION){
     const CMLFunction* colorSpectrum = (const CMLFunction*)cpGetColorControllerColorData(well->colorController);
     if(colorSpectrum){
       float colorMax = cmlGetFunctionMaxValue(colorSpectrum, &integration);
@@ -250,6 +288,9 @@ CPSpectralColorWell* cpAllocSpectralColorWell(CPColorController* colorController
   naAddUIReaction(well->openGLSpace, NA_UI_COMMAND_MOUSE_DOWN, cmDragSpectralColorWell, well);
   naAddUIReaction(well->openGLSpace, NA_UI_COMMAND_MOUSE_MOVED, cmDragSpectralColorWell, well);
   
+  well->hasBackground = NA_FALSE;
+  well->backgroundGeneration = 0;
+  well->backgroundDither = NA_FALSE;
   well->colorController = colorController;
   
   return well;
@@ -22,7 +22,9 @@
 
 - (void)applicationDidChangeScreenParameters:(NSNotification *)aNotification{
   // theoretically, needs recomputation of the screen machine. todo.
-  cpUpdateMachine();
+  // Until then, this only recomputes everything converted with the current
+  // screen machine, which stays the same.
+  cpUpdateMachine(CP_CHANGE_SCREEN);
 }
 
 - (void)applicationDidFinishLaunching:(NSNotification *)aNotification{  
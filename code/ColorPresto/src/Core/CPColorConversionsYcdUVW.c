@@ -1,6 +1,5 @@
 
 #include "CPColorConversionsYcdUVW.h"
-#include "../CPTranslations.h"
 #include "../mainC.h"
 
 
@@ -14,11 +13,3 @@ void convertYcdtoadaptedYuv(float* yuv, const float* Ycd, const float* srcWhiteP
   yuv[1] = (10.872f + 0.404f * cfactor - 4.f * dfactor) / divisor;
   yuv[2] = 5.520f / divisor;
 }
-
-const NAUTF8Char* getGrade(float value){
-  if(value <= .25f){return cpTranslate(CPGradeA);}
-  else if(value <= .5f){return cpTranslate(CPGradeB);}
-  else if(value <= 1.f){return cpTranslate(CPGradeC);}
-  else if(value <= 2.f){return cpTranslate(CPGradeD);}
-  return cpTranslate(CPGradeE);
-}
@@ -2,8 +2,6 @@
 #ifndef CP_COLOR_CONVERSION_YCD_UVW_DEFINED
 #define CP_COLOR_CONVERSION_YCD_UVW_DEFINED
 
-#include "NAUtility/NAString.h"
-
 
 
 typedef enum{
@@ -19,10 +17,6 @@ typedef enum{
 void convertYcdtoadaptedYuv(float* yuv, const float* Ycd, const float* srcWhitePointYcd, const float* dstWhitePointYcd);
 
 
-// ISO 3664 2009 Table D.9
-const NAUTF8Char* getGrade(float value);
-
-
 
 #endif // CP_COLOR_CONVERSION_YCD_UVW_DEFINED
 
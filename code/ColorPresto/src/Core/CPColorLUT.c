@@ -0,0 +1,295 @@
+
+#include "CPColorLUT.h"
+
+#include "../mainC.h"
+#include "CPRGBConversion.h"
+#include "CPScratchArena.h"
+
+#include "NAUtility/NAMemory.h"
+#include "NAUtility/NAThreading.h"
+#include <math.h>
+
+
+
+// Every color type can have one table for its normed input converter and one
+// for its normed cartesian input converter. Other converters are not cached.
+#define CP_COLOR_LUT_SLOT_COUNT 2
+// Maximal number of cell centers per axis checked against the exact result.
+#define CP_COLOR_LUT_CHECK_STEPS 16
+
+typedef struct CPColorLUT CPColorLUT;
+struct CPColorLUT{
+  NAMutex mutex;
+  NABool built;
+  NABool accurate;
+  size_t machineGeneration;
+  float* rgb;
+};
+
+struct CPColorLUTCache{
+  size_t gridSize;
+  CPColorLUT luts[CML_COLOR_COUNT][CP_COLOR_LUT_SLOT_COUNT];
+};
+
+
+
+CPColorLUTCache* cpAllocColorLUTCache(size_t gridSize){
+  #if NA_DEBUG
+    if(gridSize < 2)
+      cpError("A LUT needs at least two grid points per axis.");
+  #endif
+
+  CPColorLUTCache* cache = naAlloc(CPColorLUTCache);
+  cache->gridSize = gridSize;
+  for(size_t t = 0; t < CML_COLOR_COUNT; ++t){
+    for(size_t s = 0; s < CP_COLOR_LUT_SLOT_COUNT; ++s){
+      CPColorLUT* lut = &(cache->luts[t][s]);
+      lut->mutex = naMakeMutex();
+      lut->built = NA_FALSE;
+      lut->accurate = NA_FALSE;
+      lut->machineGeneration = 0;
+      lut->rgb = NA_NULL;
+    }
+  }
+  return cache;
+}
+
+
+
+void cpDeallocColorLUTCache(CPColorLUTCache* cache){
+  for(size_t t = 0; t < CML_COLOR_COUNT; ++t){
+    for(size_t s = 0; s < CP_COLOR_LUT_SLOT_COUNT; ++s){
+      CPColorLUT* lut = &(cache->luts[t][s]);
+      naClearMutex(lut->mutex);
+      if(lut->rgb){
+        naFree(lut->rgb);
+      }
+    }
+  }
+  naFree(cache);
+}
+
+
+
+static CPColorLUT* cp_GetColorLUT(
+  CPColorLUTCache* cache,
+  CMLColorType inputColorType,
+  CMLNormedConverter normedConverter)
+{
+  if((size_t)inputColorType >= CML_COLOR_COUNT || cmlGetNumChannels(inputColorType) != 3){
+    return NA_NULL;
+  }
+  if(normedConverter == cmlGetNormedInputConverter(inputColorType)){
+    return &(cache->luts[inputColorType][0]);
+  }
+  if(normedConverter == cmlGetNormedCartesianInputConverter(inputColorType)){
+    return &(cache->luts[inputColorType][1]);
+  }
+  return NA_NULL;
+}
+
+
+
+static float cp_ClampUnit(float value){
+  return (value < 0.f) ? 0.f : ((value > 1.f) ? 1.f : value);
+}
+
+
+
+// Tetrahedral interpolation: The unit cube of a cell is split along its
+// diagonal from c000 to c111 into six tetrahedra. Sorting the fractions
+// a >= b >= c selects the tetrahedron c000, cA, cB, c111 containing the
+// point and the result is (1 - a) c000 + (a - b) cA + (b - c) cB + c c111.
+static void cp_InterpolateColorLUT(
+  float* outData,
+  const float* rgb,
+  size_t gridSize,
+  const float* inputData,
+  size_t count)
+{
+  const float maxIndex = (float)(gridSize - 1);
+  const size_t stride2 = 3;
+  const size_t stride1 = gridSize * stride2;
+  const size_t stride0 = gridSize * stride1;
+
+  for(size_t i = 0; i < count; ++i){
+    float x = cp_ClampUnit(inputData[i * 3 + 0]) * maxIndex;
+    float y = cp_ClampUnit(inputData[i * 3 + 1]) * maxIndex;
+    float z = cp_ClampUnit(inputData[i * 3 + 2]) * maxIndex;
+    size_t ix = (size_t)x;
+    size_t iy = (size_t)y;
+    size_t iz = (size_t)z;
+    if(ix > gridSize - 2){ix = gridSize - 2;}
+    if(iy > gridSize - 2){iy = gridSize - 2;}
+    if(iz > gridSize - 2){iz = gridSize - 2;}
+    float fx = x - (float)ix;
+    float fy = y - (float)iy;
+    float fz = z - (float)iz;
+
+    float a, b, c;
+    size_t offsetA, offsetB;
+    if(fx >= fy){
+      if(fy >= fz){
+        a = fx; b = fy; c = fz; offsetA = stride0; offsetB = stride0 + stride1;
+      }else if(fx >= fz){
+        a = fx; b = fz; c = fy; offsetA = stride0; offsetB = stride0 + stride2;
+      }else{
+        a = fz; b = fx; c = fy; offsetA = stride2; offsetB = stride0 + stride2;
+      }
+    }else{
+      if(fx >= fz){
+        a = fy; b = fx; c = fz; offsetA = stride1; offsetB = stride0 + stride1;
+      }else if(fy >= fz){
+        a = fy; b = fz; c = fx; offsetA = stride1; offsetB = stride1 + stride2;
+      }else{
+        a = fz; b = fy; c = fx; offsetA = stride2; offsetB = stride1 + stride2;
+      }
+    }
+
+    const float* c000 = &(rgb[ix * stride0 + iy * stride1 + iz * stride2]);
+    const float* cA = c000 + offsetA;
+    const float* cB = c000 + offsetB;
+    const float* c111 = c000 + stride0 + stride1 + stride2;
+    float w000 = 1.f - a;
+    float wA = a - b;
+    float wB = b - c;
+    float* out = &(outData[i * 3]);
+    out[0] = w000 * c000[0] + wA * cA[0] + wB * cB[0] + c * c111[0];
+    out[1] = w000 * c000[1] + wA * cA[1] + wB * cB[1] + c * c111[1];
+    out[2] = w000 * c000[2] + wA * cA[2] + wB * cB[2] + c * c111[2];
+  }
+}
+
+
+
+// Compares the table with the exact conversion at the centers of the cells
+// where the interpolation error is largest. Large tables only check every
+// few cells. The difference is measured as CIE76 Delta E in the Lab space of
+// the screen machine.
+static NABool cp_IsColorLUTAccurate(
+  const float* rgb,
+  size_t gridSize,
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CMLColorType inputColorType,
+  CMLNormedConverter normedConverter)
+{
+  size_t cellCount = gridSize - 1;
+  size_t cellStride = (cellCount + CP_COLOR_LUT_CHECK_STEPS - 1) / CP_COLOR_LUT_CHECK_STEPS;
+  size_t checkSteps = (cellCount + cellStride - 1) / cellStride;
+  size_t checkCount = checkSteps * checkSteps * checkSteps;
+
+  CPScratchArena* arena = cpGetThreadScratchArena();
+  size_t mark = cpGetScratchArenaMark(arena);
+  float* inputData = cpAllocScratch(arena, checkCount * 3 * sizeof(float));
+  float* exactRGB = cpAllocScratch(arena, checkCount * 3 * sizeof(float));
+  float* lutRGB = cpAllocScratch(arena, checkCount * 3 * sizeof(float));
+  float* exactLab = cpAllocScratch(arena, checkCount * 3 * sizeof(float));
+  float* lutLab = cpAllocScratch(arena, checkCount * 3 * sizeof(float));
+
+  float* inputPtr = inputData;
+  for(size_t i0 = 0; i0 < checkSteps; ++i0){
+    for(size_t i1 = 0; i1 < checkSteps; ++i1){
+      for(size_t i2 = 0; i2 < checkSteps; ++i2){
+        *inputPtr++ = ((float)(i0 * cellStride) + .5f) / (float)cellCount;
+        *inputPtr++ = ((float)(i1 * cellStride) + .5f) / (float)cellCount;
+        *inputPtr++ = ((float)(i2 * cellStride) + .5f) / (float)cellCount;
+      }
+    }
+  }
+
+  fillRGBFloatArrayWithArray(machineGeneration, cm, sm, exactRGB, inputData, inputColorType, normedConverter, checkCount);
+  cp_InterpolateColorLUT(lutRGB, rgb, gridSize, inputData, checkCount);
+
+  CMLColorConverter rgbToLab = cmlGetColorConverter(CML_COLOR_Lab, CML_COLOR_RGB);
+  rgbToLab(sm, exactLab, exactRGB, checkCount);
+  rgbToLab(sm, lutLab, lutRGB, checkCount);
+
+  NABool accurate = NA_TRUE;
+  for(size_t i = 0; i < checkCount; ++i){
+    float dL = exactLab[i * 3 + 0] - lutLab[i * 3 + 0];
+    float da = exactLab[i * 3 + 1] - lutLab[i * 3 + 1];
+    float db = exactLab[i * 3 + 2] - lutLab[i * 3 + 2];
+    if(sqrtf(dL * dL + da * da + db * db) > CP_COLOR_LUT_MAX_DELTA_E){
+      accurate = NA_FALSE;
+      break;
+    }
+  }
+
+  cpResetScratchArena(arena, mark);
+
+  return accurate;
+}
+
+
+
+static void cp_BuildColorLUT(
+  CPColorLUT* lut,
+  size_t gridSize,
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CMLColorType inputColorType,
+  CMLNormedConverter normedConverter)
+{
+  size_t totalCount = gridSize * gridSize * gridSize;
+  if(!lut->rgb){
+    lut->rgb = naMalloc(totalCount * 3 * sizeof(float));
+  }
+
+  CPScratchArena* arena = cpGetThreadScratchArena();
+  size_t mark = cpGetScratchArenaMark(arena);
+  float* inputData = cpAllocScratch(arena, totalCount * 3 * sizeof(float));
+  float* inputPtr = inputData;
+  float maxIndex = (float)(gridSize - 1);
+  for(size_t i0 = 0; i0 < gridSize; ++i0){
+    for(size_t i1 = 0; i1 < gridSize; ++i1){
+      for(size_t i2 = 0; i2 < gridSize; ++i2){
+        *inputPtr++ = (float)i0 / maxIndex;
+        *inputPtr++ = (float)i1 / maxIndex;
+        *inputPtr++ = (float)i2 / maxIndex;
+      }
+    }
+  }
+
+  fillRGBFloatArrayWithArray(machineGeneration, cm, sm, lut->rgb, inputData, inputColorType, normedConverter, totalCount);
+  cpResetScratchArena(arena, mark);
+
+  lut->accurate = cp_IsColorLUTAccurate(lut->rgb, gridSize, machineGeneration, cm, sm, inputColorType, normedConverter);
+  lut->machineGeneration = machineGeneration;
+  lut->built = NA_TRUE;
+}
+
+
+
+void cpFillRGBFloatArrayWithLUT(
+  CPColorLUTCache* cache,
+  CPResponseLUT* responseLUT,
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  float* outData,
+  const float* inputData,
+  CMLColorType inputColorType,
+  CMLNormedConverter normedConverter,
+  size_t count)
+{
+  CPColorLUT* lut = cache ? cp_GetColorLUT(cache, inputColorType, normedConverter) : NA_NULL;
+
+  NABool useLUT = NA_FALSE;
+  if(lut){
+    naLockMutex(lut->mutex);
+    if(!lut->built || lut->machineGeneration != machineGeneration){
+      cp_BuildColorLUT(lut, cache->gridSize, machineGeneration, cm, sm, inputColorType, normedConverter);
+    }
+    useLUT = lut->accurate;
+    naUnlockMutex(lut->mutex);
+  }
+
+  if(useLUT){
+    cp_InterpolateColorLUT(outData, lut->rgb, cache->gridSize, inputData, count);
+  }else{
+    cpFillRGBFloatArrayWithResponseLUT(responseLUT, machineGeneration, cm, sm, outData, inputData, inputColorType, normedConverter, count);
+  }
+}
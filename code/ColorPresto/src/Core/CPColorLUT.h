@@ -0,0 +1,49 @@
+
+#ifndef CP_COLOR_LUT_DEFINED
+#define CP_COLOR_LUT_DEFINED
+
+#include "CML.h"
+#include "CPResponseLUT.h"
+
+
+
+// Caches the conversion from normed input colors to screen RGB as a 3D
+// lookup table per input color type and normed converter. The colors are
+// then evaluated by tetrahedral interpolation instead of the full chain of
+// fillRGBFloatArrayWithArray.
+//
+// A table is built lazily the first time it is used and rebuilt as soon as
+// the machine generation differs from the one it has been built with. Right
+// after building, the table is compared with the exact conversion at the
+// cell centers. If the color difference exceeds CP_COLOR_LUT_MAX_DELTA_E,
+// the table is not used and the colors get converted exactly. Types with a
+// channel count other than 3 are always converted exactly.
+
+#define CP_COLOR_LUT_MAX_DELTA_E 1.f
+
+typedef struct CPColorLUTCache CPColorLUTCache;
+
+// gridSize is the number of grid points per axis, for example 33 or 65.
+CPColorLUTCache* cpAllocColorLUTCache(size_t gridSize);
+void cpDeallocColorLUTCache(CPColorLUTCache* cache);
+
+// Same as fillRGBFloatArrayWithArray. If cache is Null or has no accurate
+// table for the type, the colors are converted with responseLUT, see
+// cpFillRGBFloatArrayWithResponseLUT. If both are Null, the colors are
+// converted exactly. Can be called from several threads at once as long as
+// all of them use the same machineGeneration.
+void cpFillRGBFloatArrayWithLUT(
+  CPColorLUTCache* cache,
+  CPResponseLUT* responseLUT,
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  float* outData,
+  const float* inputData,
+  CMLColorType inputColorType,
+  CMLNormedConverter normedConverter,
+  size_t count);
+
+
+
+#endif // CP_COLOR_LUT_DEFINED
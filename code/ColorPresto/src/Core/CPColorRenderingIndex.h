@@ -0,0 +1,46 @@
+
+#ifndef CP_COLOR_RENDERING_INDEX_DEFINED
+#define CP_COLOR_RENDERING_INDEX_DEFINED
+
+#include "CPColorConversionsYcdUVW.h"
+#include "../mainC.h"
+
+CP_PROTOTYPE(CPSpectralMatrix);
+CP_PROTOTYPE(CPSpectralWeights);
+CP_PROTOTYPE(CPWhitePoints);
+
+
+
+// /////////////////////
+// ISO 3664 2009 D.4.2 Color Rendering index
+// /////////////////////
+
+typedef struct CPColorRenderingColors CPColorRenderingColors;
+struct CPColorRenderingColors{
+  CMLVec3 crReferenceRGBFloatData[14];
+  CMLVec3 crMetamerRGBFloatData[14];
+  float colorRenderingIndex[14];
+};
+
+// Creates the remission function of the test color with the given index
+// in [0, 14). The caller has to release the function.
+CMLFunction* cpCreateColorRenderingRemission(size_t index);
+
+// Allocates the matrix holding all remissions needed for the index. The row
+// index corresponds to the index of cpCreateColorRenderingRemission.
+CPSpectralMatrix* cpAllocColorRenderingMatrix(void);
+
+CPColorRenderingColors cpComputeColorRenderingColors(
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  const CPSpectralMatrix* metamerMatrix,
+  const CPSpectralWeights* illWeights2,
+  const CPSpectralWeights* refWeights2,
+  const CPWhitePoints* refWhitePoint2,
+  const CPWhitePoints* illWhitePoint2,
+  const CMLFunction* refSpec);
+
+
+
+#endif // CP_COLOR_RENDERING_INDEX_DEFINED
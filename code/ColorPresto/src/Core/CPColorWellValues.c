@@ -0,0 +1,159 @@
+#include "CPColorWellValues.h"
+
+#include "CPRGBConversion.h"
+#include "CPScratchArena.h"
+
+
+
+void cpFillColorWell2DRows(
+  NAByte* rgbaValues,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  size_t machineGeneration,
+  CMLColorType colorType,
+  const float* normedColorValues,
+  size_t fixedIndex,
+  size_t size,
+  size_t rowStart,
+  size_t rowCount,
+  NABool dither)
+{
+  CMLNormedConverter inputConverter = cmlGetNormedCartesianInputConverter(colorType);
+  size_t count = rowCount * size;
+
+  CPScratchArena* arena = cpGetThreadScratchArena();
+  size_t mark = cpGetScratchArenaMark(arena);
+  float* inputValues = cpAllocScratch(arena, count * 3 * sizeof(float));
+  float* rgbValues = cpAllocScratch(arena, count * 3 * sizeof(float));
+
+  // The channels varying along x and y.
+  size_t xChannel = (fixedIndex == 0) ? 1 : 0;
+  size_t yChannel = (fixedIndex == 2) ? 1 : 2;
+
+  float* inputPtr = inputValues;
+  for(size_t y = rowStart; y < rowStart + rowCount; ++y){
+    float yValue = (float)y / (float)size;
+    for(size_t x = 0; x < size; ++x){
+      float xValue = (float)x / (float)size;
+      cmlCpy3(inputPtr, normedColorValues);
+      inputPtr[xChannel] = xValue;
+      inputPtr[yChannel] = yValue;
+      inputPtr += 3;
+    }
+  }
+
+  // Convert the given values to screen RGBs.
+  cpFillRGBFloatArrayWithLUT(
+    lutCache,
+    responseLUT,
+    machineGeneration,
+    cm,
+    sm,
+    rgbValues,
+    inputValues,
+    colorType,
+    inputConverter,
+    count);
+
+  cpFillRGBA8ArrayWithRGB(
+    &(rgbaValues[rowStart * size * 4]),
+    rgbValues,
+    size,
+    rowStart,
+    rowCount,
+    dither);
+
+  cpResetScratchArena(arena, mark);
+}
+
+
+
+void cpFillColorWell1DValues(
+  NAByte* rgbaValues,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  size_t machineGeneration,
+  CMLColorType colorType,
+  const float* normedColorValues,
+  size_t variableIndex,
+  size_t size,
+  NABool dither)
+{
+  cpFillColorWell1DValuesBatch(
+    &rgbaValues,
+    &variableIndex,
+    1,
+    cm,
+    sm,
+    lutCache,
+    responseLUT,
+    machineGeneration,
+    colorType,
+    normedColorValues,
+    size,
+    dither);
+}
+
+
+
+void cpFillColorWell1DValuesBatch(
+  NAByte* const* rgbaValues,
+  const size_t* variableIndices,
+  size_t wellCount,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  size_t machineGeneration,
+  CMLColorType colorType,
+  const float* normedColorValues,
+  size_t size,
+  NABool dither)
+{
+  CMLNormedConverter inputConverter = cmlGetNormedInputConverter(colorType);
+  size_t numChannels = cmlGetNumChannels(colorType);
+  size_t count = wellCount * size;
+
+  CPScratchArena* arena = cpGetThreadScratchArena();
+  size_t mark = cpGetScratchArenaMark(arena);
+  float* inputValues = cpAllocScratch(arena, count * 3 * sizeof(float));
+  float* rgbValues = cpAllocScratch(arena, count * 3 * sizeof(float));
+
+  // The samples of all wells follow each other.
+  float* inputPtr = inputValues;
+  for(size_t w = 0; w < wellCount; ++w){
+    for(size_t x = 0; x < size; ++x){
+      float xValue = (float)x / (float)size;
+      if(numChannels == 1){
+        *inputPtr++ = xValue;
+      }else{
+        cmlCpy3(inputPtr, normedColorValues);
+        inputPtr[variableIndices[w]] = xValue;
+        inputPtr += 3;
+      }
+    }
+  }
+
+  // Convert the given values to screen RGBs.
+  cpFillRGBFloatArrayWithLUT(
+    lutCache,
+    responseLUT,
+    machineGeneration,
+    cm,
+    sm,
+    rgbValues,
+    inputValues,
+    colorType,
+    inputConverter,
+    count);
+
+  for(size_t w = 0; w < wellCount; ++w){
+    cpFillRGBA8ArrayWithRGB(rgbaValues[w], &(rgbValues[w * size * 3]), size, 0, 1, dither);
+  }
+
+  cpResetScratchArena(arena, mark);
+}
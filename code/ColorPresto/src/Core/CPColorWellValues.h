@@ -0,0 +1,72 @@
+
+#ifndef CP_COLOR_WELL_VALUES_DEFINED
+#define CP_COLOR_WELL_VALUES_DEFINED
+
+#include "CML.h"
+#include "NABase/NABase.h"
+#include "CPColorLUT.h"
+
+
+
+// Computes the screen colors of the color wells as 8 bit RGBA, ready to be
+// uploaded as texture. Both functions work on normed cartesian values: All
+// channels are taken from normedColorValues except the ones varying along
+// the well, which go from 0 to 1. The temporaries come from the scratch arena
+// of the calling thread. If lutCache or responseLUT is not Null, the colors
+// are evaluated with its lookup tables, see cpFillRGBFloatArrayWithLUT.
+// dither selects the ordered dither of cpFillRGBA8ArrayWithRGB.
+
+// Fills rowCount rows starting at rowStart of a square well with size
+// pixels per side. The two channels other than fixedIndex vary along x and y.
+// rgbaValues holds size * size * 4 bytes.
+void cpFillColorWell2DRows(
+  NAByte* rgbaValues,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  size_t machineGeneration,
+  CMLColorType colorType,
+  const float* normedColorValues,
+  size_t fixedIndex,
+  size_t size,
+  size_t rowStart,
+  size_t rowCount,
+  NABool dither);
+
+// Fills a well of size pixels in which the channel variableIndex varies.
+// Colors with one channel ignore variableIndex. rgbaValues holds size * 4
+// bytes.
+void cpFillColorWell1DValues(
+  NAByte* rgbaValues,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  size_t machineGeneration,
+  CMLColorType colorType,
+  const float* normedColorValues,
+  size_t variableIndex,
+  size_t size,
+  NABool dither);
+
+// Same as cpFillColorWell1DValues for wellCount wells of the same color. Well
+// w varies the channel variableIndices[w] and is written into rgbaValues[w].
+// All samples are converted in a single call which shares the setup of the
+// conversion among the wells.
+void cpFillColorWell1DValuesBatch(
+  NAByte* const* rgbaValues,
+  const size_t* variableIndices,
+  size_t wellCount,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  size_t machineGeneration,
+  CMLColorType colorType,
+  const float* normedColorValues,
+  size_t size,
+  NABool dither);
+
+
+#endif // CP_COLOR_WELL_VALUES_DEFINED
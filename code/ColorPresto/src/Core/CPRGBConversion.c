@@ -0,0 +1,373 @@
+
+#include "CPRGBConversion.h"
+
+#include "../mainC.h"
+
+#include "NAUtility/NAMemory.h"
+#include "NAUtility/NAThreading.h"
+#include <math.h>
+
+
+
+// Number of colors converted at once by fillRGBFloatArrayWithArray. All
+// temporaries of one tile together take about 10 KB and stay in L1 cache.
+#define CP_RGB_TILE_SIZE 256
+#define CP_RGB_TILE_MAX_CHANNELS 4
+
+// Bayer matrix of the ordered dither, with thresholds 0 to 63.
+static const NAByte cpBayer8x8[8][8] = {
+  { 0, 32,  8, 40,  2, 34, 10, 42},
+  {48, 16, 56, 24, 50, 18, 58, 26},
+  {12, 44,  4, 36, 14, 46,  6, 38},
+  {60, 28, 52, 20, 62, 30, 54, 22},
+  { 3, 35, 11, 43,  1, 33,  9, 41},
+  {51, 19, 59, 27, 49, 17, 57, 25},
+  {15, 47,  7, 39, 13, 45,  5, 37},
+  {63, 31, 55, 23, 61, 29, 53, 21},
+};
+
+// Multiplies all values of a tile in place with the given matrix. CMLMat33
+// stores its columns consecutively. The loop has no dependencies between the
+// elements and gets vectorized by the compiler.
+static void cp_MulMat33Tile(float* values, const CMLMat33 matrix, size_t count){
+  const float m0 = matrix[0];
+  const float m1 = matrix[1];
+  const float m2 = matrix[2];
+  const float m3 = matrix[3];
+  const float m4 = matrix[4];
+  const float m5 = matrix[5];
+  const float m6 = matrix[6];
+  const float m7 = matrix[7];
+  const float m8 = matrix[8];
+  for(size_t i = 0; i < count; ++i){
+    float X = values[i * 3 + 0];
+    float Y = values[i * 3 + 1];
+    float Z = values[i * 3 + 2];
+    values[i * 3 + 0] = m0 * X + m3 * Y + m6 * Z;
+    values[i * 3 + 1] = m1 * X + m4 * Y + m7 * Z;
+    values[i * 3 + 2] = m2 * X + m5 * Y + m8 * Z;
+  }
+}
+
+
+
+// The inverse of the transposed matrix is the transposed inverse. Hence the
+// formula works for both storage orders.
+static NABool cp_InvertMat33(CMLMat33 out, const CMLMat33 m){
+  float det = m[0] * (m[4] * m[8] - m[5] * m[7])
+    - m[1] * (m[3] * m[8] - m[5] * m[6])
+    + m[2] * (m[3] * m[7] - m[4] * m[6]);
+  if(det == 0.f){
+    return NA_FALSE;
+  }
+  float invDet = 1.f / det;
+  out[0] = (m[4] * m[8] - m[5] * m[7]) * invDet;
+  out[1] = (m[2] * m[7] - m[1] * m[8]) * invDet;
+  out[2] = (m[1] * m[5] - m[2] * m[4]) * invDet;
+  out[3] = (m[5] * m[6] - m[3] * m[8]) * invDet;
+  out[4] = (m[0] * m[8] - m[2] * m[6]) * invDet;
+  out[5] = (m[2] * m[3] - m[0] * m[5]) * invDet;
+  out[6] = (m[3] * m[7] - m[4] * m[6]) * invDet;
+  out[7] = (m[1] * m[6] - m[0] * m[7]) * invDet;
+  out[8] = (m[0] * m[4] - m[1] * m[3]) * invDet;
+  return NA_TRUE;
+}
+
+
+
+// How XYZ values of the color machine become screen RGB for one pair of
+// machines:
+// - Without adaptation, cmlXYZToRGB of the screen machine is used as it is.
+// - With adaptation, the adaptation matrix and the matrix from XYZ to linear
+//   screen RGB are combined into one matrix, followed by the response curves
+//   of the screen machine.
+// - Should the combined path deviate from adapting and converting one after
+//   the other, which only happens with curves CML does not evaluate the way
+//   it converts, the two steps are kept separate.
+typedef struct CPScreenTransform CPScreenTransform;
+struct CPScreenTransform{
+  NABool adapt;
+  NABool combined;
+  CMLMat33 adaptationMatrix;
+  CMLMat33 xyzToLinearRGB;
+  const CMLFunction* responses[3];
+};
+
+// The transform of the latest pair of machines, shared by all threads. It
+// is rebuilt whenever one of the machines or their generation differs.
+typedef struct CPScreenTransformCache CPScreenTransformCache;
+struct CPScreenTransformCache{
+  NAMutex mutex;
+  NABool valid;
+  const CMLColorMachine* cm;
+  const CMLColorMachine* sm;
+  size_t machineGeneration;
+  CPScreenTransform transform;
+};
+
+static CPScreenTransformCache* cpScreenTransformCache = NA_NULL;
+
+// Number of colors checked against the separate steps after building.
+#define CP_SCREEN_TRANSFORM_CHECK_COUNT 8
+// The combined matrix sums in a different order. After clamping, this stays
+// far below the step between two 8 bit values.
+#define CP_SCREEN_TRANSFORM_MAX_ERROR 1e-5f
+
+
+
+void cpStartupRGBConversion(){
+  #if NA_DEBUG
+    if(cpScreenTransformCache)
+      cpError("RGB conversion already started.");
+  #endif
+  cpScreenTransformCache = naAlloc(CPScreenTransformCache);
+  cpScreenTransformCache->mutex = naMakeMutex();
+  cpScreenTransformCache->valid = NA_FALSE;
+}
+
+
+
+void cpShutdownRGBConversion(){
+  naClearMutex(cpScreenTransformCache->mutex);
+  naFree(cpScreenTransformCache);
+  cpScreenTransformCache = NA_NULL;
+}
+
+
+
+NABool cpFillAdaptationMatrix(CMLMat33 matrix, const CMLColorMachine* cm, const CMLColorMachine* sm){
+  // Only the chromaticities matter, the luminance is set to 1.
+  CMLVec3 cmWhitePointYxy;
+  CMLVec3 smWhitePointYxy;
+  cmlCpy3(cmWhitePointYxy, cmlGetWhitePointYxy(cm));
+  cmWhitePointYxy[0] = 1.f;
+  cmlCpy3(smWhitePointYxy, cmlGetWhitePointYxy(sm));
+  smWhitePointYxy[0] = 1.f;
+
+  if(cmWhitePointYxy[1] == smWhitePointYxy[1] && cmWhitePointYxy[2] == smWhitePointYxy[2]){
+    return NA_FALSE;
+  }
+  cmlFillChromaticAdaptationMatrix(matrix, CML_CHROMATIC_ADAPTATION_NONE, smWhitePointYxy, cmWhitePointYxy);
+  return NA_TRUE;
+}
+
+
+
+NABool cpFillLinearScreenMatrix(CMLMat33 matrix, const CMLColorMachine* cm, const CMLColorMachine* sm){
+  // All curves map 0 to 0 and 1 to 1. Hence the XYZ of the screen primaries
+  // are the columns of the matrix from linear screen RGB to XYZ.
+  const CMLMat33 primaries = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f};
+  CMLColorConverter rgbToXYZ = cmlGetColorConverter(CML_COLOR_XYZ, CML_COLOR_RGB);
+  CMLMat33 smRGBToXYZ;
+  CMLMat33 xyzToLinearRGB;
+  rgbToXYZ(sm, smRGBToXYZ, primaries, 3);
+  NABool valid = cp_InvertMat33(xyzToLinearRGB, smRGBToXYZ);
+
+  CMLMat33 adaptationMatrix;
+  if(cpFillAdaptationMatrix(adaptationMatrix, cm, sm)){
+    // Every column of the product is the screen matrix applied to the
+    // corresponding column of the adaptation matrix.
+    cmlCpy3(&(matrix[0]), &(adaptationMatrix[0]));
+    cmlCpy3(&(matrix[3]), &(adaptationMatrix[3]));
+    cmlCpy3(&(matrix[6]), &(adaptationMatrix[6]));
+    cp_MulMat33Tile(matrix, xyzToLinearRGB, 3);
+  }else{
+    naCopyn(matrix, xyzToLinearRGB, sizeof(CMLMat33));
+  }
+  return valid;
+}
+
+
+
+static void cp_ConvertXYZToScreenRGB(const CPScreenTransform* transform, const CMLColorMachine* sm, float* outRGB, float* xyz, size_t count){
+  if(transform->combined){
+    naCopyn(outRGB, xyz, count * 3 * sizeof(float));
+    cp_MulMat33Tile(outRGB, transform->xyzToLinearRGB, count);
+    for(size_t i = 0; i < count; ++i){
+      outRGB[i * 3 + 0] = cmlEval(transform->responses[0], outRGB[i * 3 + 0]);
+      outRGB[i * 3 + 1] = cmlEval(transform->responses[1], outRGB[i * 3 + 1]);
+      outRGB[i * 3 + 2] = cmlEval(transform->responses[2], outRGB[i * 3 + 2]);
+    }
+  }else{
+    if(transform->adapt){
+      cp_MulMat33Tile(xyz, transform->adaptationMatrix, count);
+    }
+    cmlXYZToRGB(sm, outRGB, xyz, count);
+  }
+  cmlClampRGB(outRGB, count);
+}
+
+
+
+static void cp_BuildScreenTransform(CPScreenTransform* transform, const CMLColorMachine* cm, const CMLColorMachine* sm){
+  transform->adapt = cpFillAdaptationMatrix(transform->adaptationMatrix, cm, sm);
+  transform->combined = NA_FALSE;
+  if(!transform->adapt){
+    return;
+  }
+
+  if(!cpFillLinearScreenMatrix(transform->xyzToLinearRGB, cm, sm)){
+    return;
+  }
+  transform->responses[0] = cmlGetResponseCurveFunc(cmlGetResponseR(sm));
+  transform->responses[1] = cmlGetResponseCurveFunc(cmlGetResponseG(sm));
+  transform->responses[2] = cmlGetResponseCurveFunc(cmlGetResponseB(sm));
+
+  // The white point, the primaries, a dark gray and two mixed colors of the
+  // color machine, converted once with and once without the combined matrix.
+  const float checkRGB[CP_SCREEN_TRANSFORM_CHECK_COUNT * 3] = {
+    1.f, 1.f, 1.f,
+    1.f, 0.f, 0.f,
+    0.f, 1.f, 0.f,
+    0.f, 0.f, 1.f,
+    .05f, .05f, .05f,
+    .8f, .4f, .1f,
+    .2f, .6f, .9f,
+    .5f, .5f, .5f,
+  };
+  float xyz[CP_SCREEN_TRANSFORM_CHECK_COUNT * 3];
+  float separateRGB[CP_SCREEN_TRANSFORM_CHECK_COUNT * 3];
+  float combinedRGB[CP_SCREEN_TRANSFORM_CHECK_COUNT * 3];
+
+  CMLColorConverter rgbToXYZ = cmlGetColorConverter(CML_COLOR_XYZ, CML_COLOR_RGB);
+  rgbToXYZ(cm, xyz, checkRGB, CP_SCREEN_TRANSFORM_CHECK_COUNT);
+  transform->combined = NA_TRUE;
+  cp_ConvertXYZToScreenRGB(transform, sm, combinedRGB, xyz, CP_SCREEN_TRANSFORM_CHECK_COUNT);
+  transform->combined = NA_FALSE;
+  cp_ConvertXYZToScreenRGB(transform, sm, separateRGB, xyz, CP_SCREEN_TRANSFORM_CHECK_COUNT);
+
+  NABool accurate = NA_TRUE;
+  for(size_t i = 0; i < CP_SCREEN_TRANSFORM_CHECK_COUNT * 3; ++i){
+    if(!(fabsf(separateRGB[i] - combinedRGB[i]) <= CP_SCREEN_TRANSFORM_MAX_ERROR)){
+      accurate = NA_FALSE;
+      break;
+    }
+  }
+  transform->combined = accurate;
+}
+
+
+
+// Copies the transform for the given machines into transform, building it
+// first if the cached one belongs to other machines or another generation.
+static void cp_GetScreenTransform(CPScreenTransform* transform, size_t machineGeneration, const CMLColorMachine* cm, const CMLColorMachine* sm){
+  CPScreenTransformCache* cache = cpScreenTransformCache;
+  #if NA_DEBUG
+    if(!cache)
+      cpError("RGB conversion not started.");
+  #endif
+  naLockMutex(cache->mutex);
+  if(!cache->valid
+    || cache->cm != cm
+    || cache->sm != sm
+    || cache->machineGeneration != machineGeneration)
+  {
+    cp_BuildScreenTransform(&(cache->transform), cm, sm);
+    cache->cm = cm;
+    cache->sm = sm;
+    cache->machineGeneration = machineGeneration;
+    cache->valid = NA_TRUE;
+  }
+  *transform = cache->transform;
+  naUnlockMutex(cache->mutex);
+}
+
+
+
+// Converts normed input colors to clamped screen RGB. The whole conversion
+// chain runs on one tile after the other instead of on the full array, and
+// nothing gets allocated. Without lut, the XYZ values go through transform,
+// which equals the separate conversions within
+// CP_SCREEN_TRANSFORM_MAX_ERROR. With lut, the response curves are taken
+// from its tables and the adaptation is part of its screen matrix.
+static void cp_FillRGBTiles(const CPResponseLUT* lut, const CPScreenTransform* transform, const CMLColorMachine* cm, const CMLColorMachine* sm, float* outData, const float* inputData, CMLColorType inputColorType, CMLNormedConverter normedConverter, size_t count){
+  
+  size_t numColorChannels = cmlGetNumChannels(inputColorType);
+  #if NA_DEBUG
+    if(numColorChannels > CP_RGB_TILE_MAX_CHANNELS)
+      cpError("Color type has too many channels for a tile.");
+  #endif
+
+  CMLColorConverter colorToXYZ = cmlGetColorConverter(CML_COLOR_XYZ, inputColorType);
+
+  // HSV and HSL are converted to RGB first and then through the tables.
+  NABool lutInput = lut && (inputColorType == CML_COLOR_RGB || inputColorType == CML_COLOR_HSV || inputColorType == CML_COLOR_HSL);
+  CMLColorConverter colorToRGB = (lutInput && inputColorType != CML_COLOR_RGB)
+    ? cmlGetColorConverter(CML_COLOR_RGB, inputColorType)
+    : NA_NULL;
+
+  float colorTile[CP_RGB_TILE_SIZE * CP_RGB_TILE_MAX_CHANNELS];
+  float XYZTile[CP_RGB_TILE_SIZE * 3];
+
+  for(size_t start = 0; start < count; start += CP_RGB_TILE_SIZE){
+    size_t tileCount = count - start;
+    if(tileCount > CP_RGB_TILE_SIZE){
+      tileCount = CP_RGB_TILE_SIZE;
+    }
+    float* outTile = &(outData[start * 3]);
+
+    normedConverter(colorTile, &(inputData[start * numColorChannels]), tileCount);
+    if(colorToRGB){
+      colorToRGB(cm, XYZTile, colorTile, tileCount);
+      cpConvertRGBToXYZWithResponseLUT(lut, XYZTile, XYZTile, tileCount);
+    }else if(lutInput){
+      cpConvertRGBToXYZWithResponseLUT(lut, XYZTile, colorTile, tileCount);
+    }else{
+      colorToXYZ(cm, XYZTile, colorTile, tileCount);
+    }
+    if(lut){
+      cpConvertXYZToRGBWithResponseLUT(lut, outTile, XYZTile, tileCount);
+    }else{
+      cp_ConvertXYZToScreenRGB(transform, sm, outTile, XYZTile, tileCount);
+    }
+  }
+}
+
+
+
+void fillRGBFloatArrayWithArray(size_t machineGeneration, const CMLColorMachine* cm, const CMLColorMachine* sm, float* outData, const float* inputData, CMLColorType inputColorType, CMLNormedConverter normedConverter, size_t count){
+  CPScreenTransform transform;
+  cp_GetScreenTransform(&transform, machineGeneration, cm, sm);
+  cp_FillRGBTiles(NA_NULL, &transform, cm, sm, outData, inputData, inputColorType, normedConverter, count);
+}
+
+
+
+void cpFillRGBFloatArrayWithResponseTables(const CPResponseLUT* lut, const CMLColorMachine* cm, const CMLColorMachine* sm, float* outData, const float* inputData, CMLColorType inputColorType, CMLNormedConverter normedConverter, size_t count){
+  cp_FillRGBTiles(lut, NA_NULL, cm, sm, outData, inputData, inputColorType, normedConverter, count);
+}
+
+
+
+static NAByte cp_QuantizeRGB8(float value, float offset){
+  float scaled = value * 255.f + offset;
+  if(scaled <= 0.f){return 0;}
+  if(scaled >= 255.f){return 255;}
+  return (NAByte)scaled;
+}
+
+
+
+void cpFillRGBA8ArrayWithRGB(NAByte* outData, const float* rgbValues, size_t width, size_t rowStart, size_t rowCount, NABool dither){
+  for(size_t r = 0; r < rowCount; ++r){
+    // Rounding is truncation after adding .5. The dither replaces the .5 by
+    // thresholds spread evenly between 0 and 1.
+    float offsets[8];
+    const NAByte* bayerRow = cpBayer8x8[(rowStart + r) % 8];
+    for(size_t i = 0; i < 8; ++i){
+      offsets[i] = dither ? ((float)bayerRow[i] + .5f) / 64.f : .5f;
+    }
+
+    const float* rgbPtr = &(rgbValues[r * width * 3]);
+    NAByte* outPtr = &(outData[r * width * 4]);
+    for(size_t x = 0; x < width; ++x){
+      float offset = offsets[x % 8];
+      outPtr[0] = cp_QuantizeRGB8(rgbPtr[0], offset);
+      outPtr[1] = cp_QuantizeRGB8(rgbPtr[1], offset);
+      outPtr[2] = cp_QuantizeRGB8(rgbPtr[2], offset);
+      outPtr[3] = 255;
+      rgbPtr += 3;
+      outPtr += 4;
+    }
+  }
+}
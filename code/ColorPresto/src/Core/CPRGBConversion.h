@@ -0,0 +1,80 @@
+
+#ifndef CP_RGB_CONVERSION_DEFINED
+#define CP_RGB_CONVERSION_DEFINED
+
+#include "CML.h"
+#include "NABase/NABase.h"
+#include "CPResponseLUT.h"
+
+
+
+// Must be called before the first conversion and after the last one.
+void cpStartupRGBConversion(void);
+void cpShutdownRGBConversion(void);
+
+// Converts count colors of the given type, normed with normedConverter, to
+// clamped screen RGB values. cm is the machine the colors are defined in, sm
+// is the machine of the screen.
+//
+// If the white points of the machines differ, the chromatic adaptation and
+// the matrix from XYZ to linear screen RGB are combined into one matrix
+// which is applied once per color. It is built once per pair of machines and
+// machineGeneration and shared by all threads, hence machineGeneration must
+// change whenever one of the machines does.
+void fillRGBFloatArrayWithArray(
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  float* outData,
+  const float* inputData,
+  CMLColorType inputColorType,
+  CMLNormedConverter normedConverter,
+  size_t count);
+
+// Same as fillRGBFloatArrayWithArray, but RGB inputs and the screen RGB are
+// converted with the tables of lut as they are. HSV and HSL inputs go
+// through RGB. Use cpFillRGBFloatArrayWithResponseLUT which checks the
+// tables first.
+void cpFillRGBFloatArrayWithResponseTables(
+  const CPResponseLUT* lut,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  float* outData,
+  const float* inputData,
+  CMLColorType inputColorType,
+  CMLNormedConverter normedConverter,
+  size_t count);
+
+// Fills matrix with the adaptation from the white point of cm to the one of
+// sm. Returns NA_FALSE without touching matrix if the white points are the
+// same and no adaptation is needed.
+NABool cpFillAdaptationMatrix(
+  CMLMat33 matrix,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm);
+
+// Fills matrix with the conversion from XYZ of cm to linear RGB of sm,
+// including the adaptation between their white points. The matrix is derived
+// from the primaries of sm. Returns NA_FALSE if they are degenerate.
+NABool cpFillLinearScreenMatrix(
+  CMLMat33 matrix,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm);
+
+// Packs the clamped RGB values of rowCount rows of width pixels into 8 bit
+// RGBA with opaque alpha. rowStart is the row of the first value, only
+// needed to place the pattern when dither is set: Then an 8x8 ordered dither
+// is added before rounding, turning the bands of smooth gradients into a
+// pattern too fine to notice. Otherwise the values are rounded, just like a
+// driver does when uploading floats into an 8 bit texture.
+void cpFillRGBA8ArrayWithRGB(
+  NAByte* outData,
+  const float* rgbValues,
+  size_t width,
+  size_t rowStart,
+  size_t rowCount,
+  NABool dither);
+
+
+
+#endif // CP_RGB_CONVERSION_DEFINED
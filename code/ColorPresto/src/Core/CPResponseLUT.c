@@ -0,0 +1,323 @@
+
+#include "CPResponseLUT.h"
+
+#include "../mainC.h"
+#include "CPRGBConversion.h"
+#include "CPScratchArena.h"
+
+#include "NAUtility/NAMemory.h"
+#include "NAUtility/NAThreading.h"
+#include <math.h>
+
+
+
+// Number of colors per axis of the grid checked against the exact result.
+#define CP_RESPONSE_LUT_CHECK_STEPS 17
+
+struct CPResponseLUT{
+  NAMutex mutex;
+  NABool built;
+  NABool accurate;
+  size_t machineGeneration;
+  CMLMat33 rgbToXYZ; // linear RGB of the color machine to XYZ
+  CMLMat33 xyzToRGB; // XYZ to linear RGB of the screen machine, adapted
+  float inverse[3][CP_RESPONSE_LUT_SIZE];
+  float forward[3][CP_RESPONSE_LUT_SIZE];
+};
+
+
+
+CPResponseLUT* cpAllocResponseLUT(){
+  CPResponseLUT* lut = naAlloc(CPResponseLUT);
+  lut->mutex = naMakeMutex();
+  lut->built = NA_FALSE;
+  lut->accurate = NA_FALSE;
+  lut->machineGeneration = 0;
+  return lut;
+}
+
+
+
+void cpDeallocResponseLUT(CPResponseLUT* lut){
+  naClearMutex(lut->mutex);
+  naFree(lut);
+}
+
+
+
+static float cp_ClampUnit(float value){
+  return (value < 0.f) ? 0.f : ((value > 1.f) ? 1.f : value);
+}
+
+
+
+// CMLMat33 stores its columns consecutively. out and in may be the same.
+static void cp_MulMat33(float* out, const CMLMat33 m, const float* in){
+  float x = in[0];
+  float y = in[1];
+  float z = in[2];
+  out[0] = m[0] * x + m[3] * y + m[6] * z;
+  out[1] = m[1] * x + m[4] * y + m[7] * z;
+  out[2] = m[2] * x + m[5] * y + m[8] * z;
+}
+
+
+
+// index goes from 0 to CP_RESPONSE_LUT_SIZE - 1.
+static float cp_InterpolateResponse(const float* table, float index){
+  size_t i0 = (size_t)index;
+  if(i0 > CP_RESPONSE_LUT_SIZE - 2){i0 = CP_RESPONSE_LUT_SIZE - 2;}
+  float t = index - (float)i0;
+  return table[i0] + t * (table[i0 + 1] - table[i0]);
+}
+
+
+
+void cpConvertRGBToXYZWithResponseLUT(
+  const CPResponseLUT* lut,
+  float* outXYZ,
+  const float* inputRGB,
+  size_t count)
+{
+  const float maxIndex = (float)(CP_RESPONSE_LUT_SIZE - 1);
+  for(size_t i = 0; i < count; ++i){
+    float linear[3];
+    linear[0] = cp_InterpolateResponse(lut->inverse[0], cp_ClampUnit(inputRGB[i * 3 + 0]) * maxIndex);
+    linear[1] = cp_InterpolateResponse(lut->inverse[1], cp_ClampUnit(inputRGB[i * 3 + 1]) * maxIndex);
+    linear[2] = cp_InterpolateResponse(lut->inverse[2], cp_ClampUnit(inputRGB[i * 3 + 2]) * maxIndex);
+    cp_MulMat33(&(outXYZ[i * 3]), lut->rgbToXYZ, linear);
+  }
+}
+
+
+
+static void cp_ConvertLinearToRGBWithResponseLUT(
+  const CPResponseLUT* lut,
+  float* out,
+  const float* linear)
+{
+  const float maxIndex = (float)(CP_RESPONSE_LUT_SIZE - 1);
+  for(size_t c = 0; c < 3; ++c){
+    float index = sqrtf(cp_ClampUnit(linear[c])) * maxIndex;
+    out[c] = cp_ClampUnit(cp_InterpolateResponse(lut->forward[c], index));
+  }
+}
+
+
+
+void cpConvertXYZToRGBWithResponseLUT(
+  const CPResponseLUT* lut,
+  float* outRGB,
+  const float* inputXYZ,
+  size_t count)
+{
+  for(size_t i = 0; i < count; ++i){
+    float linear[3];
+    cp_MulMat33(linear, lut->xyzToRGB, &(inputXYZ[i * 3]));
+    cp_ConvertLinearToRGBWithResponseLUT(lut, &(outRGB[i * 3]), linear);
+  }
+}
+
+
+
+// Compares the tables with the exact conversion in the middle between the
+// samples, where the interpolation error is largest, and on a grid of colors
+// which mixes all channels and both matrices.
+static NABool cp_IsResponseLUTAccurate(
+  const CPResponseLUT* lut,
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm)
+{
+  const float maxIndex = (float)(CP_RESPONSE_LUT_SIZE - 1);
+  size_t midCount = 3 * (CP_RESPONSE_LUT_SIZE - 1);
+  size_t gridCount = CP_RESPONSE_LUT_CHECK_STEPS * CP_RESPONSE_LUT_CHECK_STEPS * CP_RESPONSE_LUT_CHECK_STEPS;
+  size_t rgbCount = midCount + gridCount;
+
+  CPScratchArena* arena = cpGetThreadScratchArena();
+  size_t mark = cpGetScratchArenaMark(arena);
+  float* inputRGB = cpAllocScratch(arena, rgbCount * 3 * sizeof(float));
+  float* inputXYZ = cpAllocScratch(arena, midCount * 3 * sizeof(float));
+  float* inputLinear = cpAllocScratch(arena, midCount * 3 * sizeof(float));
+  float* exactRGB = cpAllocScratch(arena, rgbCount * 3 * sizeof(float));
+  float* lutRGB = cpAllocScratch(arena, rgbCount * 3 * sizeof(float));
+
+  // The inverse curves are checked with encoded inputs of the color machine.
+  float* rgbPtr = inputRGB;
+  for(size_t c = 0; c < 3; ++c){
+    for(size_t k = 0; k < CP_RESPONSE_LUT_SIZE - 1; ++k){
+      cmlSet3(rgbPtr, 0.f, 0.f, 0.f);
+      rgbPtr[c] = ((float)k + .5f) / maxIndex;
+      rgbPtr += 3;
+    }
+  }
+  for(size_t i0 = 0; i0 < CP_RESPONSE_LUT_CHECK_STEPS; ++i0){
+    for(size_t i1 = 0; i1 < CP_RESPONSE_LUT_CHECK_STEPS; ++i1){
+      for(size_t i2 = 0; i2 < CP_RESPONSE_LUT_CHECK_STEPS; ++i2){
+        *rgbPtr++ = (float)i0 / (float)(CP_RESPONSE_LUT_CHECK_STEPS - 1);
+        *rgbPtr++ = (float)i1 / (float)(CP_RESPONSE_LUT_CHECK_STEPS - 1);
+        *rgbPtr++ = (float)i2 / (float)(CP_RESPONSE_LUT_CHECK_STEPS - 1);
+      }
+    }
+  }
+
+  CMLNormedConverter normedConverter = cmlGetNormedInputConverter(CML_COLOR_RGB);
+  fillRGBFloatArrayWithArray(machineGeneration, cm, sm, exactRGB, inputRGB, CML_COLOR_RGB, normedConverter, rgbCount);
+  cpFillRGBFloatArrayWithResponseTables(lut, cm, sm, lutRGB, inputRGB, CML_COLOR_RGB, normedConverter, rgbCount);
+
+  NABool accurate = NA_TRUE;
+  for(size_t i = 0; i < rgbCount * 3; ++i){
+    if(fabsf(exactRGB[i] - lutRGB[i]) > CP_RESPONSE_LUT_MAX_ERROR){
+      accurate = NA_FALSE;
+      break;
+    }
+  }
+
+  // The forward curves are checked with linear values in the middle between
+  // the samples of one channel. As the adaptation is part of the screen
+  // matrix of the tables, the curves are applied to the linear values
+  // directly and compared with the screen XYZ of the same values.
+  if(accurate){
+    const CMLMat33 primaries = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f};
+    CMLColorConverter rgbToXYZ = cmlGetColorConverter(CML_COLOR_XYZ, CML_COLOR_RGB);
+    CMLMat33 smRGBToXYZ;
+    rgbToXYZ(sm, smRGBToXYZ, primaries, 3);
+    float* xyzPtr = inputXYZ;
+    float* linearPtr = inputLinear;
+    for(size_t c = 0; c < 3; ++c){
+      const float* column = &(smRGBToXYZ[c * 3]);
+      for(size_t k = 0; k < CP_RESPONSE_LUT_SIZE - 1; ++k){
+        float u = ((float)k + .5f) / maxIndex;
+        xyzPtr[0] = u * u * column[0];
+        xyzPtr[1] = u * u * column[1];
+        xyzPtr[2] = u * u * column[2];
+        cmlSet3(linearPtr, 0.f, 0.f, 0.f);
+        linearPtr[c] = u * u;
+        xyzPtr += 3;
+        linearPtr += 3;
+      }
+    }
+    cmlXYZToRGB(sm, exactRGB, inputXYZ, midCount);
+    cmlClampRGB(exactRGB, midCount);
+    for(size_t i = 0; i < midCount; ++i){
+      cp_ConvertLinearToRGBWithResponseLUT(lut, &(lutRGB[i * 3]), &(inputLinear[i * 3]));
+    }
+    for(size_t i = 0; i < midCount * 3; ++i){
+      if(fabsf(exactRGB[i] - lutRGB[i]) > CP_RESPONSE_LUT_MAX_ERROR){
+        accurate = NA_FALSE;
+        break;
+      }
+    }
+  }
+
+  cpResetScratchArena(arena, mark);
+
+  return accurate;
+}
+
+
+
+static void cp_BuildResponseLUT(
+  CPResponseLUT* lut,
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm)
+{
+  const float maxIndex = (float)(CP_RESPONSE_LUT_SIZE - 1);
+  size_t sampleCount = 3 * CP_RESPONSE_LUT_SIZE;
+  CMLColorConverter rgbToXYZ = cmlGetColorConverter(CML_COLOR_XYZ, CML_COLOR_RGB);
+
+  // All curves map 0 to 0 and 1 to 1. Hence the XYZ of the primaries are
+  // the columns of the matrix from linear RGB to XYZ. Should a curve behave
+  // otherwise, the check after building fails.
+  const CMLMat33 primaries = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f};
+  CMLMat33 smRGBToXYZ;
+  rgbToXYZ(cm, lut->rgbToXYZ, primaries, 3);
+  rgbToXYZ(sm, smRGBToXYZ, primaries, 3);
+  NABool valid = cpFillLinearScreenMatrix(lut->xyzToRGB, cm, sm);
+
+  CPScratchArena* arena = cpGetThreadScratchArena();
+  size_t mark = cpGetScratchArenaMark(arena);
+  float* rgb = cpAllocScratch(arena, sampleCount * 3 * sizeof(float));
+  float* xyz = cpAllocScratch(arena, sampleCount * 3 * sizeof(float));
+
+  // The inverse curves: Every encoded sample of one channel results in the
+  // XYZ of its primary scaled by the linear value.
+  float* rgbPtr = rgb;
+  for(size_t c = 0; c < 3; ++c){
+    for(size_t k = 0; k < CP_RESPONSE_LUT_SIZE; ++k){
+      cmlSet3(rgbPtr, 0.f, 0.f, 0.f);
+      rgbPtr[c] = (float)k / maxIndex;
+      rgbPtr += 3;
+    }
+  }
+  rgbToXYZ(cm, xyz, rgb, sampleCount);
+  for(size_t c = 0; c < 3; ++c){
+    const float* column = &(lut->rgbToXYZ[c * 3]);
+    float norm = column[0] * column[0] + column[1] * column[1] + column[2] * column[2];
+    if(norm == 0.f){
+      valid = NA_FALSE;
+      break;
+    }
+    for(size_t k = 0; k < CP_RESPONSE_LUT_SIZE; ++k){
+      const float* xyzPtr = &(xyz[(c * CP_RESPONSE_LUT_SIZE + k) * 3]);
+      lut->inverse[c][k] = (xyzPtr[0] * column[0] + xyzPtr[1] * column[1] + xyzPtr[2] * column[2]) / norm;
+    }
+  }
+
+  // The forward curves: The XYZ of the screen primaries scaled by the
+  // squared sample position result in the encoded value of one channel.
+  float* xyzPtr = xyz;
+  for(size_t c = 0; c < 3; ++c){
+    const float* column = &(smRGBToXYZ[c * 3]);
+    for(size_t k = 0; k < CP_RESPONSE_LUT_SIZE; ++k){
+      float u = (float)k / maxIndex;
+      xyzPtr[0] = u * u * column[0];
+      xyzPtr[1] = u * u * column[1];
+      xyzPtr[2] = u * u * column[2];
+      xyzPtr += 3;
+    }
+  }
+  cmlXYZToRGB(sm, rgb, xyz, sampleCount);
+  for(size_t c = 0; c < 3; ++c){
+    for(size_t k = 0; k < CP_RESPONSE_LUT_SIZE; ++k){
+      lut->forward[c][k] = rgb[(c * CP_RESPONSE_LUT_SIZE + k) * 3 + c];
+    }
+  }
+
+  cpResetScratchArena(arena, mark);
+
+  lut->accurate = valid && cp_IsResponseLUTAccurate(lut, machineGeneration, cm, sm);
+  lut->machineGeneration = machineGeneration;
+  lut->built = NA_TRUE;
+}
+
+
+
+void cpFillRGBFloatArrayWithResponseLUT(
+  CPResponseLUT* lut,
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  float* outData,
+  const float* inputData,
+  CMLColorType inputColorType,
+  CMLNormedConverter normedConverter,
+  size_t count)
+{
+  NABool useLUT = NA_FALSE;
+  if(lut){
+    naLockMutex(lut->mutex);
+    if(!lut->built || lut->machineGeneration != machineGeneration){
+      cp_BuildResponseLUT(lut, machineGeneration, cm, sm);
+    }
+    useLUT = lut->accurate;
+    naUnlockMutex(lut->mutex);
+  }
+
+  if(useLUT){
+    cpFillRGBFloatArrayWithResponseTables(lut, cm, sm, outData, inputData, inputColorType, normedConverter, count);
+  }else{
+    fillRGBFloatArrayWithArray(machineGeneration, cm, sm, outData, inputData, inputColorType, normedConverter, count);
+  }
+}
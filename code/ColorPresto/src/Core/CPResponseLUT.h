@@ -0,0 +1,81 @@
+
+#ifndef CP_RESPONSE_LUT_DEFINED
+#define CP_RESPONSE_LUT_DEFINED
+
+#include "CML.h"
+#include "NABase/NABase.h"
+
+
+
+// Caches the response curves of the RGB conversions as lookup tables of
+// CP_RESPONSE_LUT_SIZE entries per channel, evaluated by linear
+// interpolation instead of a pow per channel and color:
+// - The inverse tables hold the curves of the color machine which turn
+//   encoded RGB into linear RGB, sampled evenly between 0 and 1.
+// - The forward tables hold the curves of the screen machine which turn
+//   linear RGB into encoded RGB. They are sampled evenly in the square root
+//   of the linear value, which follows the steep start of gamma curves.
+// Together with the curves, the matrices between linear RGB and XYZ are
+// taken from the machines by converting the primaries. The chromatic
+// adaptation between the white points is part of the screen matrix. Linear
+// or encoded values outside of [0, 1] are clamped.
+//
+// The tables are built lazily the first time they are used and rebuilt as
+// soon as the machine generation differs from the one they have been built
+// with. Right after building, the conversion with the tables is compared
+// with the exact conversion in the middle between the samples of every
+// channel and on a grid of colors. If any clamped screen RGB value deviates
+// by more than CP_RESPONSE_LUT_MAX_ERROR, the tables are not used and the
+// colors get converted exactly. This is the case for example with custom
+// gammas far below 1 whose curves are too steep near 0. With the sRGB curves
+// on both machines, the deviation stays below 1e-5. Pure gamma curves on the
+// screen come closer to the limit in the darkest colors, where even the
+// rounding of the exact matrices changes the result by that much.
+
+#define CP_RESPONSE_LUT_SIZE 4096
+// A quarter of the step between two 8 bit values.
+#define CP_RESPONSE_LUT_MAX_ERROR (.25f / 255.f)
+
+typedef struct CPResponseLUT CPResponseLUT;
+
+CPResponseLUT* cpAllocResponseLUT(void);
+void cpDeallocResponseLUT(CPResponseLUT* lut);
+
+// Same as fillRGBFloatArrayWithArray. If lut is Null or its tables are not
+// accurate enough, the colors are converted exactly. Can be called from
+// several threads at once as long as all of them use the same
+// machineGeneration.
+void cpFillRGBFloatArrayWithResponseLUT(
+  CPResponseLUT* lut,
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  float* outData,
+  const float* inputData,
+  CMLColorType inputColorType,
+  CMLNormedConverter normedConverter,
+  size_t count);
+
+// Converts count encoded RGB values of the color machine to XYZ. outXYZ and
+// inputRGB may be the same array.
+void cpConvertRGBToXYZWithResponseLUT(
+  const CPResponseLUT* lut,
+  float* outXYZ,
+  const float* inputRGB,
+  size_t count);
+
+// Converts count XYZ values of the color machine to encoded RGB of the
+// screen machine, adapted to its white point and clamped to [0, 1]. outRGB
+// and inputXYZ may be the same array.
+//
+// Both conversions use the tables as they are. They must only be called
+// with a lut which cpFillRGBFloatArrayWithResponseLUT has found accurate.
+void cpConvertXYZToRGBWithResponseLUT(
+  const CPResponseLUT* lut,
+  float* outRGB,
+  const float* inputXYZ,
+  size_t count);
+
+
+
+#endif // CP_RESPONSE_LUT_DEFINED
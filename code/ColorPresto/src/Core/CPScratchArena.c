@@ -0,0 +1,205 @@
+
+#include "CPScratchArena.h"
+
+#include "NAUtility/NAMemory.h"
+#include "NAUtility/NAThreading.h"
+
+
+
+#define CP_SCRATCH_ALIGN 32
+#define CP_SCRATCH_INITIAL_SIZE (256 * 1024)
+
+// An arena grows by adding chunks. The previous chunks stay valid until the
+// arena gets reset below their base.
+typedef struct CPScratchChunk CPScratchChunk;
+struct CPScratchChunk{
+  CPScratchChunk* prev;
+  void* buffer;
+  NAByte* data;    // buffer aligned to CP_SCRATCH_ALIGN
+  size_t capacity;
+  size_t base;     // mark of the first byte of this chunk
+};
+
+struct CPScratchArena{
+  CPScratchChunk* chunk;
+  size_t used;
+  size_t peak;
+  size_t heapAllocationCount;
+  CPScratchArena* next;
+};
+
+// All living arenas, for the counters.
+static NAMutex cpScratchArenasMutex;
+static CPScratchArena* cpScratchArenas = NA_NULL;
+static size_t cpReleasedScratchPeakBytes = 0;
+static size_t cpReleasedScratchHeapAllocationCount = 0;
+
+static CP_THREAD_LOCAL CPScratchArena* cpThreadScratchArena = NA_NULL;
+
+
+
+static size_t cp_AlignScratchSize(size_t size){
+  return (size + CP_SCRATCH_ALIGN - 1) & ~(size_t)(CP_SCRATCH_ALIGN - 1);
+}
+
+
+
+static void cp_PushScratchChunk(CPScratchArena* arena, size_t capacity){
+  CPScratchChunk* chunk = naAlloc(CPScratchChunk);
+  chunk->buffer = naMalloc(capacity + CP_SCRATCH_ALIGN);
+  chunk->data = (NAByte*)cp_AlignScratchSize((size_t)chunk->buffer);
+  chunk->capacity = capacity;
+  chunk->base = arena->used;
+  chunk->prev = arena->chunk;
+  arena->chunk = chunk;
+  arena->heapAllocationCount++;
+}
+
+
+
+static void cp_PopScratchChunk(CPScratchArena* arena){
+  CPScratchChunk* chunk = arena->chunk;
+  arena->chunk = chunk->prev;
+  naFree(chunk->buffer);
+  naFree(chunk);
+}
+
+
+
+void cpStartupScratchArenas(){
+  cpScratchArenasMutex = naMakeMutex();
+  cpScratchArenas = NA_NULL;
+  cpReleasedScratchPeakBytes = 0;
+  cpReleasedScratchHeapAllocationCount = 0;
+}
+
+
+
+void cpShutdownScratchArenas(){
+  #if NA_DEBUG
+    if(cpScratchArenas){
+      cpError("There are still arenas which have not been released.");
+    }
+  #endif
+  naClearMutex(cpScratchArenasMutex);
+}
+
+
+
+CPScratchArena* cpGetThreadScratchArena(){
+  if(!cpThreadScratchArena){
+    CPScratchArena* arena = naAlloc(CPScratchArena);
+    arena->chunk = NA_NULL;
+    arena->used = 0;
+    arena->peak = 0;
+    arena->heapAllocationCount = 0;
+    cp_PushScratchChunk(arena, CP_SCRATCH_INITIAL_SIZE);
+
+    naLockMutex(cpScratchArenasMutex);
+    arena->next = cpScratchArenas;
+    cpScratchArenas = arena;
+    naUnlockMutex(cpScratchArenasMutex);
+
+    cpThreadScratchArena = arena;
+  }
+  return cpThreadScratchArena;
+}
+
+
+
+void cpReleaseThreadScratchArena(){
+  CPScratchArena* arena = cpThreadScratchArena;
+  if(!arena){
+    return;
+  }
+
+  naLockMutex(cpScratchArenasMutex);
+  CPScratchArena** link = &cpScratchArenas;
+  while(*link != arena){
+    link = &((*link)->next);
+  }
+  *link = arena->next;
+  cpReleasedScratchPeakBytes += arena->peak;
+  cpReleasedScratchHeapAllocationCount += arena->heapAllocationCount;
+  naUnlockMutex(cpScratchArenasMutex);
+
+  while(arena->chunk){
+    cp_PopScratchChunk(arena);
+  }
+  naFree(arena);
+  cpThreadScratchArena = NA_NULL;
+}
+
+
+
+size_t cpGetScratchArenaMark(const CPScratchArena* arena){
+  return arena->used;
+}
+
+
+
+void cpResetScratchArena(CPScratchArena* arena, size_t mark){
+  #if NA_DEBUG
+    if(mark > arena->used)
+      cpError("Mark lies behind the used memory.");
+  #endif
+
+  NABool hadChunks = NA_FALSE;
+  while(arena->chunk->prev && arena->chunk->base >= mark){
+    cp_PopScratchChunk(arena);
+    hadChunks = NA_TRUE;
+  }
+  arena->used = mark;
+
+  // Once empty, the chunks are replaced by a single one which is large
+  // enough for everything seen so far. From then on, no more chunks are
+  // needed unless a computation grows.
+  if(mark == 0 && hadChunks){
+    cp_PopScratchChunk(arena);
+    cp_PushScratchChunk(arena, arena->peak);
+  }
+}
+
+
+
+void* cpAllocScratch(CPScratchArena* arena, size_t size){
+  size = cp_AlignScratchSize(size ? size : 1);
+
+  CPScratchChunk* chunk = arena->chunk;
+  if(arena->used + size > chunk->base + chunk->capacity){
+    size_t capacity = 2 * chunk->capacity;
+    cp_PushScratchChunk(arena, (capacity > size) ? capacity : size);
+    chunk = arena->chunk;
+  }
+
+  void* ptr = &(chunk->data[arena->used - chunk->base]);
+  arena->used += size;
+  if(arena->used > arena->peak){
+    arena->peak = arena->used;
+  }
+  return ptr;
+}
+
+
+
+size_t cpGetScratchArenaPeakBytes(){
+  naLockMutex(cpScratchArenasMutex);
+  size_t peakBytes = cpReleasedScratchPeakBytes;
+  for(const CPScratchArena* arena = cpScratchArenas; arena; arena = arena->next){
+    peakBytes += arena->peak;
+  }
+  naUnlockMutex(cpScratchArenasMutex);
+  return peakBytes;
+}
+
+
+
+size_t cpGetScratchArenaHeapAllocationCount(){
+  naLockMutex(cpScratchArenasMutex);
+  size_t count = cpReleasedScratchHeapAllocationCount;
+  for(const CPScratchArena* arena = cpScratchArenas; arena; arena = arena->next){
+    count += arena->heapAllocationCount;
+  }
+  naUnlockMutex(cpScratchArenasMutex);
+  return count;
+}
@@ -0,0 +1,46 @@
+
+#ifndef CP_SCRATCH_ARENA_DEFINED
+#define CP_SCRATCH_ARENA_DEFINED
+
+#include "../mainC.h"
+
+
+
+// Bump allocator for the temporaries of the computations. Every thread owns
+// its own arena, hence no locking is needed and the threads do not contend
+// on the heap. A function takes a mark before allocating and resets its arena
+// to that mark before returning, which frees everything allocated since.
+//
+// Memory is only requested from the heap while an arena grows. Once it is
+// large enough for the biggest computation, steady interaction allocates
+// nothing at all.
+
+typedef struct CPScratchArena CPScratchArena;
+
+// Must be called before any thread uses an arena and after all of them have
+// released theirs.
+void cpStartupScratchArenas(void);
+void cpShutdownScratchArenas(void);
+
+// Returns the arena of the calling thread, creating it on first use.
+CPScratchArena* cpGetThreadScratchArena(void);
+// Frees the arena of the calling thread. Threads call this before they end.
+void cpReleaseThreadScratchArena(void);
+
+size_t cpGetScratchArenaMark(const CPScratchArena* arena);
+void cpResetScratchArena(CPScratchArena* arena, size_t mark);
+
+// Returns uninitialized memory aligned to 32 bytes which stays valid until
+// the arena is reset to a mark taken before the allocation.
+void* cpAllocScratch(CPScratchArena* arena, size_t size);
+
+// Counters of all arenas since startup, including the released ones: The sum
+// of the highest number of bytes each arena had in use at once, and the
+// number of times the arenas called the heap. Only exact while no thread is
+// computing.
+size_t cpGetScratchArenaPeakBytes(void);
+size_t cpGetScratchArenaHeapAllocationCount(void);
+
+
+
+#endif // CP_SCRATCH_ARENA_DEFINED
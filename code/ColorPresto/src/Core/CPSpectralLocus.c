@@ -0,0 +1,154 @@
+
+#include "CPSpectralLocus.h"
+
+#include "../mainC.h"
+#include "CPScratchArena.h"
+
+#include "NAUtility/NAMemory.h"
+
+
+
+// Every color type can keep the coordinates of its normed and its normed
+// cartesian output converter. Other converters replace the first slot.
+#define CP_SPECTRAL_LOCUS_SLOT_COUNT 2
+
+typedef struct CPSpectralLocusCoords CPSpectralLocusCoords;
+struct CPSpectralLocusCoords{
+  NABool valid;
+  CMLNormedConverter normedConverter;
+  float* values;
+};
+
+struct CPSpectralLocus{
+  NABool built;
+  size_t machineGeneration;
+  const CMLColorMachine* cm;
+  size_t count;
+  float* xyz;
+  float* rgb;
+  CPSpectralLocusCoords coords[CML_COLOR_COUNT][CP_SPECTRAL_LOCUS_SLOT_COUNT];
+};
+
+
+
+CPSpectralLocus* cpAllocSpectralLocus(){
+  CPSpectralLocus* locus = naAlloc(CPSpectralLocus);
+  locus->built = NA_FALSE;
+  locus->machineGeneration = 0;
+  locus->cm = NA_NULL;
+
+  float iMin = CML_DEFAULT_INTEGRATION_MIN;
+  float iMax = CML_DEFAULT_INTEGRATION_MAX;
+  size_t intervals = (size_t)((iMax - iMin) / CML_DEFAULT_INTEGRATION_STEPSIZE) + 1;
+  locus->count = intervals + 1;
+  locus->xyz = naMalloc(locus->count * 3 * sizeof(float));
+  locus->rgb = naMalloc(locus->count * 3 * sizeof(float));
+
+  for(size_t t = 0; t < CML_COLOR_COUNT; ++t){
+    for(size_t s = 0; s < CP_SPECTRAL_LOCUS_SLOT_COUNT; ++s){
+      locus->coords[t][s].valid = NA_FALSE;
+      locus->coords[t][s].normedConverter = NA_NULL;
+      locus->coords[t][s].values = NA_NULL;
+    }
+  }
+  return locus;
+}
+
+
+
+void cpDeallocSpectralLocus(CPSpectralLocus* locus){
+  for(size_t t = 0; t < CML_COLOR_COUNT; ++t){
+    for(size_t s = 0; s < CP_SPECTRAL_LOCUS_SLOT_COUNT; ++s){
+      if(locus->coords[t][s].values){
+        naFree(locus->coords[t][s].values);
+      }
+    }
+  }
+  naFree(locus->xyz);
+  naFree(locus->rgb);
+  naFree(locus);
+}
+
+
+
+void cpUpdateSpectralLocus(
+  CPSpectralLocus* locus,
+  const CMLColorMachine* cm,
+  size_t machineGeneration)
+{
+  if(locus->built && locus->machineGeneration == machineGeneration){
+    return;
+  }
+
+  // Same sampling as the spectrum lines have always been drawn with.
+  float iMin = CML_DEFAULT_INTEGRATION_MIN;
+  float iMax = CML_DEFAULT_INTEGRATION_MAX;
+  size_t intervals = locus->count - 1;
+  for(size_t i = 0; i < locus->count; ++i){
+    float l = iMin + (((iMax - iMin) * i) / intervals);
+    cmlGetSpectralXYZColor(cm, &(locus->xyz[i * 3]), l);
+  }
+  cmlXYZToRGB(cm, locus->rgb, locus->xyz, locus->count);
+
+  for(size_t t = 0; t < CML_COLOR_COUNT; ++t){
+    for(size_t s = 0; s < CP_SPECTRAL_LOCUS_SLOT_COUNT; ++s){
+      locus->coords[t][s].valid = NA_FALSE;
+    }
+  }
+
+  locus->cm = cm;
+  locus->machineGeneration = machineGeneration;
+  locus->built = NA_TRUE;
+}
+
+
+
+size_t cpGetSpectralLocusCount(const CPSpectralLocus* locus){
+  return locus->count;
+}
+
+
+
+const float* cpGetSpectralLocusXYZ(const CPSpectralLocus* locus){
+  return locus->xyz;
+}
+
+
+
+const float* cpGetSpectralLocusRGB(const CPSpectralLocus* locus){
+  return locus->rgb;
+}
+
+
+
+const float* cpGetSpectralLocusNormedCoords(
+  CPSpectralLocus* locus,
+  CMLColorType colorType,
+  CMLNormedConverter normedConverter)
+{
+  #if NA_DEBUG
+    if(!locus->built)
+      cpError("Spectral locus has not been built.");
+    if((size_t)colorType >= CML_COLOR_COUNT)
+      cpError("Invalid color type.");
+  #endif
+
+  size_t slot = (normedConverter == cmlGetNormedCartesianOutputConverter(colorType)) ? 1 : 0;
+  CPSpectralLocusCoords* coords = &(locus->coords[colorType][slot]);
+
+  if(!coords->valid || coords->normedConverter != normedConverter){
+    if(!coords->values){
+      coords->values = naMalloc(locus->count * 3 * sizeof(float));
+    }
+    CPScratchArena* arena = cpGetThreadScratchArena();
+    size_t mark = cpGetScratchArenaMark(arena);
+    float* coordValues = cpAllocScratch(arena, locus->count * 3 * sizeof(float));
+    CMLColorConverter coordConverter = cmlGetColorConverter(colorType, CML_COLOR_XYZ);
+    coordConverter(locus->cm, coordValues, locus->xyz, locus->count);
+    normedConverter(coords->values, coordValues, locus->count);
+    cpResetScratchArena(arena, mark);
+    coords->normedConverter = normedConverter;
+    coords->valid = NA_TRUE;
+  }
+  return coords->values;
+}
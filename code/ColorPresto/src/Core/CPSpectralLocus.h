@@ -0,0 +1,46 @@
+
+#ifndef CP_SPECTRAL_LOCUS_DEFINED
+#define CP_SPECTRAL_LOCUS_DEFINED
+
+#include "CML.h"
+#include "NABase/NABase.h"
+
+
+
+// Caches the spectral locus of a color machine: The XYZ and RGB of the
+// monochromatic colors between CML_DEFAULT_INTEGRATION_MIN and
+// CML_DEFAULT_INTEGRATION_MAX, sampled like the spectrum lines are drawn.
+// The normed coordinates of a color type are computed on first request.
+//
+// The locus is rebuilt as soon as the machine generation differs from the
+// one it has been built with. It must only be used from the main thread.
+
+typedef struct CPSpectralLocus CPSpectralLocus;
+
+CPSpectralLocus* cpAllocSpectralLocus(void);
+void cpDeallocSpectralLocus(CPSpectralLocus* locus);
+
+// Rebuilds the locus if machineGeneration differs from the last call.
+void cpUpdateSpectralLocus(
+  CPSpectralLocus* locus,
+  const CMLColorMachine* cm,
+  size_t machineGeneration);
+
+size_t cpGetSpectralLocusCount(const CPSpectralLocus* locus);
+
+// Arrays of count XYZ or RGB values. The RGB values are neither scaled nor
+// clamped. Samples with a Y of 0 or less are outside the visible range.
+const float* cpGetSpectralLocusXYZ(const CPSpectralLocus* locus);
+const float* cpGetSpectralLocusRGB(const CPSpectralLocus* locus);
+
+// Returns the coordinates of all samples in colorType, normed with
+// normedConverter. Every color type keeps the values of its normed and its
+// normed cartesian output converter.
+const float* cpGetSpectralLocusNormedCoords(
+  CPSpectralLocus* locus,
+  CMLColorType colorType,
+  CMLNormedConverter normedConverter);
+
+
+
+#endif // CP_SPECTRAL_LOCUS_DEFINED
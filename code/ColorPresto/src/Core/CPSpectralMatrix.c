@@ -0,0 +1,220 @@
+
+#include "CPSpectralMatrix.h"
+
+#include "NAUtility/NAMemory.h"
+
+
+
+// The inner loops accumulate into this many independent lanes which allows
+// the compiler to use SIMD instructions. Compared to a sequential sum, this
+// reorders the additions, therefore the results differ from cmlFilterFunction
+// by float rounding. The benchmark checks the deviation, see
+// cp_CheckSpectralMatrix.
+#define CP_SPECTRAL_LANES 8
+#define CP_SPECTRAL_ALIGN 32
+
+struct CPSpectralMatrix{
+  size_t rowCount;
+  size_t rowCapacity;
+  size_t stride;   // grid count padded to a multiple of CP_SPECTRAL_LANES
+  void* buffer;
+  float* values;   // rowCapacity rows of stride values, aligned
+};
+
+struct CPSpectralWeights{
+  size_t stride;
+  void* buffer;
+  float* illumination;
+  float* weights[3];
+};
+
+
+
+static size_t cp_GetSpectralGridCount(void){
+  return (size_t)((CML_DEFAULT_INTEGRATION_MAX - CML_DEFAULT_INTEGRATION_MIN) / CML_DEFAULT_INTEGRATION_STEPSIZE) + 1;
+}
+
+
+
+static size_t cp_GetSpectralGridStride(void){
+  size_t count = cp_GetSpectralGridCount();
+  return ((count + CP_SPECTRAL_LANES - 1) / CP_SPECTRAL_LANES) * CP_SPECTRAL_LANES;
+}
+
+
+
+static float cp_GetSpectralGridLambda(size_t index){
+  return CML_DEFAULT_INTEGRATION_MIN + (float)index * CML_DEFAULT_INTEGRATION_STEPSIZE;
+}
+
+
+
+static float* cp_AllocAlignedFloats(void** buffer, size_t count){
+  *buffer = naMalloc(count * sizeof(float) + CP_SPECTRAL_ALIGN);
+  size_t address = (size_t)*buffer;
+  size_t aligned = (address + CP_SPECTRAL_ALIGN - 1) & ~(size_t)(CP_SPECTRAL_ALIGN - 1);
+  float* values = (float*)aligned;
+  // Zero all values, the padding must not contribute to any sum.
+  for(size_t i = 0; i < count; ++i){
+    values[i] = 0.f;
+  }
+  return values;
+}
+
+
+
+CPSpectralMatrix* cpAllocSpectralMatrix(size_t rowCapacity){
+  CPSpectralMatrix* matrix = naAlloc(CPSpectralMatrix);
+  matrix->rowCount = 0;
+  matrix->rowCapacity = rowCapacity;
+  matrix->stride = cp_GetSpectralGridStride();
+  matrix->values = cp_AllocAlignedFloats(&(matrix->buffer), rowCapacity * matrix->stride);
+  return matrix;
+}
+
+
+
+void cpDeallocSpectralMatrix(CPSpectralMatrix* matrix){
+  naFree(matrix->buffer);
+  naFree(matrix);
+}
+
+
+
+size_t cpAddSpectralMatrixRow(CPSpectralMatrix* matrix, const CMLFunction* func){
+  #if NA_DEBUG
+    if(matrix->rowCount >= matrix->rowCapacity){
+      cpError("Spectral matrix is full.");
+    }
+  #endif
+  size_t row = matrix->rowCount;
+  float* rowValues = &(matrix->values[row * matrix->stride]);
+  size_t count = cp_GetSpectralGridCount();
+  for(size_t i = 0; i < count; ++i){
+    rowValues[i] = cmlEval(func, cp_GetSpectralGridLambda(i));
+  }
+  matrix->rowCount++;
+  return row;
+}
+
+
+
+size_t cpAddSpectralMatrixRowWithArray(
+  CPSpectralMatrix* matrix,
+  const float* data,
+  size_t count,
+  float lambdaMin,
+  float lambdaMax)
+{
+  CMLArrayFunctionInput input = {
+    data,
+    NA_FALSE,
+    { count,
+      lambdaMin,
+      lambdaMax,
+      CML_INTERPOLATION_LINEAR,
+      CML_EXTRAPOLATION_LINEAR_ZERO,
+      CML_EXTRAPOLATION_LINEAR_ZERO}};
+  CMLFunction* func = cmlCreateArrayFunction(input);
+  size_t row = cpAddSpectralMatrixRow(matrix, func);
+  cmlReleaseFunction(func);
+  return row;
+}
+
+
+
+CPSpectralWeights* cpAllocSpectralWeights(void){
+  CPSpectralWeights* weights = naAlloc(CPSpectralWeights);
+  weights->stride = cp_GetSpectralGridStride();
+  weights->illumination = cp_AllocAlignedFloats(&(weights->buffer), 4 * weights->stride);
+  weights->weights[0] = &(weights->illumination[1 * weights->stride]);
+  weights->weights[1] = &(weights->illumination[2 * weights->stride]);
+  weights->weights[2] = &(weights->illumination[3 * weights->stride]);
+  return weights;
+}
+
+
+
+void cpDeallocSpectralWeights(CPSpectralWeights* weights){
+  naFree(weights->buffer);
+  naFree(weights);
+}
+
+
+
+void cpFillSpectralWeights(
+  CPSpectralWeights* weights,
+  const CMLFunction* illumination,
+  CMLFunction* const observerFuncs[3])
+{
+  size_t count = cp_GetSpectralGridCount();
+  for(size_t i = 0; i < count; ++i){
+    float lambda = cp_GetSpectralGridLambda(i);
+    float illuminationValue = illumination ? cmlEval(illumination, lambda) : 1.f;
+    weights->illumination[i] = illuminationValue * CML_DEFAULT_INTEGRATION_STEPSIZE;
+    weights->weights[0][i] = weights->illumination[i] * cmlEval(observerFuncs[0], lambda);
+    weights->weights[1][i] = weights->illumination[i] * cmlEval(observerFuncs[1], lambda);
+    weights->weights[2][i] = weights->illumination[i] * cmlEval(observerFuncs[2], lambda);
+  }
+}
+
+
+
+void cpMultiplySpectralMatrix(
+  float* xyz,
+  const CPSpectralMatrix* matrix,
+  size_t firstRow,
+  size_t rowCount,
+  const CPSpectralWeights* weights)
+{
+  const float* wx = weights->weights[0];
+  const float* wy = weights->weights[1];
+  const float* wz = weights->weights[2];
+
+  for(size_t row = firstRow; row < firstRow + rowCount; ++row){
+    const float* rowValues = &(matrix->values[row * matrix->stride]);
+    float accX[CP_SPECTRAL_LANES] = {0.f};
+    float accY[CP_SPECTRAL_LANES] = {0.f};
+    float accZ[CP_SPECTRAL_LANES] = {0.f};
+
+    for(size_t i = 0; i < matrix->stride; i += CP_SPECTRAL_LANES){
+      for(size_t l = 0; l < CP_SPECTRAL_LANES; ++l){
+        accX[l] += rowValues[i + l] * wx[i + l];
+        accY[l] += rowValues[i + l] * wy[i + l];
+        accZ[l] += rowValues[i + l] * wz[i + l];
+      }
+    }
+
+    float sumX = 0.f;
+    float sumY = 0.f;
+    float sumZ = 0.f;
+    for(size_t l = 0; l < CP_SPECTRAL_LANES; ++l){
+      sumX += accX[l];
+      sumY += accY[l];
+      sumZ += accZ[l];
+    }
+    cmlSet3(xyz, sumX, sumY, sumZ);
+    xyz += 3;
+  }
+}
+
+
+
+float cpIntegrateSpectralMatrixRow(
+  const CPSpectralMatrix* matrix,
+  size_t row,
+  const CPSpectralWeights* weights)
+{
+  const float* rowValues = &(matrix->values[row * matrix->stride]);
+  float acc[CP_SPECTRAL_LANES] = {0.f};
+  for(size_t i = 0; i < matrix->stride; i += CP_SPECTRAL_LANES){
+    for(size_t l = 0; l < CP_SPECTRAL_LANES; ++l){
+      acc[l] += rowValues[i + l] * weights->illumination[i + l];
+    }
+  }
+  float sum = 0.f;
+  for(size_t l = 0; l < CP_SPECTRAL_LANES; ++l){
+    sum += acc[l];
+  }
+  return sum;
+}
@@ -0,0 +1,59 @@
+
+
+#ifndef CP_SPECTRAL_MATRIX_DEFINED
+#define CP_SPECTRAL_MATRIX_DEFINED
+
+#include "../mainC.h"
+
+
+
+// Dense representation of the spectral data used by the metamerics. Every
+// row of the matrix holds one remission spectrum sampled on a common
+// wavelength grid which corresponds to the default integration of CML.
+// Tristimulus values are computed as one matrix product against weight
+// vectors holding illumination times observer times the step size.
+
+typedef struct CPSpectralMatrix CPSpectralMatrix;
+typedef struct CPSpectralWeights CPSpectralWeights;
+
+CPSpectralMatrix* cpAllocSpectralMatrix(size_t rowCapacity);
+void cpDeallocSpectralMatrix(CPSpectralMatrix* matrix);
+
+// Samples the given function on the grid and appends it as a new row.
+// Returns the index of the row.
+size_t cpAddSpectralMatrixRow(CPSpectralMatrix* matrix, const CMLFunction* func);
+// Convenience function for sampled data with linear interpolation.
+size_t cpAddSpectralMatrixRowWithArray(
+  CPSpectralMatrix* matrix,
+  const float* data,
+  size_t count,
+  float lambdaMin,
+  float lambdaMax);
+
+CPSpectralWeights* cpAllocSpectralWeights(void);
+void cpDeallocSpectralWeights(CPSpectralWeights* weights);
+
+// Fills the weights with illumination times the three observer functions.
+// If illumination is Null, the observer functions are used alone.
+void cpFillSpectralWeights(
+  CPSpectralWeights* weights,
+  const CMLFunction* illumination,
+  CMLFunction* const observerFuncs[3]);
+
+// Stores rowCount XYZ triplets starting with firstRow into xyz.
+void cpMultiplySpectralMatrix(
+  float* xyz,
+  const CPSpectralMatrix* matrix,
+  size_t firstRow,
+  size_t rowCount,
+  const CPSpectralWeights* weights);
+
+// Integrates the given row multiplied with the illumination of the weights.
+float cpIntegrateSpectralMatrixRow(
+  const CPSpectralMatrix* matrix,
+  size_t row,
+  const CPSpectralWeights* weights);
+
+
+
+#endif // CP_SPECTRAL_MATRIX_DEFINED
@@ -0,0 +1,648 @@
+
+#include "CML.h"
+#include "NAMath/NAMath.h"
+#include "NAUtility/NAMemory.h"
+#include "CPThreeDeeMesh.h"
+#include "CPScratchArena.h"
+
+
+
+#define CP_THREEDEE_MAX_SURFACE_COUNT 6
+
+typedef size_t CMLVec4UInt[CML_MAX_NUMBER_OF_CHANNELS];
+
+inline static void cmlSet4UInt(CMLVec4UInt d, size_t a0, size_t a1, size_t a2, size_t a3){
+  d[0] = a0;
+  d[1] = a1;
+  d[2] = a2;
+  d[3] = a3;
+}
+
+typedef struct CPThreeDeeSurface CPThreeDeeSurface;
+struct CPThreeDeeSurface{
+  size_t steps1;
+  size_t steps2;
+  float* normedSystemCoords;
+  float* rgbFloatValues;
+  NABool* cellVisible;
+};
+
+struct CPThreeDeeMesh{
+  size_t surfaceRevision;
+  size_t pointRevision;
+  NABool valid;
+  CMLColorType colorType;
+  CoordSysType coordSysType;
+  NAInt steps3D;
+  size_t machineGeneration;
+
+  size_t surfaceCount;
+  CPThreeDeeSurface surfaces[CP_THREEDEE_MAX_SURFACE_COUNT];
+  size_t visibleCellCount; // of all surfaces together
+
+  NABool hasPointCloud;
+  size_t pointCount;
+  float* pointCoords;
+  float* pointRGB;
+};
+
+
+
+CPThreeDeeMesh* cpAllocThreeDeeMesh(void){
+  CPThreeDeeMesh* mesh = naAlloc(CPThreeDeeMesh);
+  mesh->surfaceRevision = 0;
+  mesh->pointRevision = 0;
+  mesh->valid = NA_FALSE;
+  mesh->surfaceCount = 0;
+  mesh->visibleCellCount = 0;
+  mesh->hasPointCloud = NA_FALSE;
+  mesh->pointCount = 0;
+  mesh->pointCoords = NA_NULL;
+  mesh->pointRGB = NA_NULL;
+  return mesh;
+}
+
+
+
+static void cp_ClearThreeDeeMesh(CPThreeDeeMesh* mesh){
+  for(size_t s = 0; s < mesh->surfaceCount; ++s){
+    naFree(mesh->surfaces[s].cellVisible);
+    naFree(mesh->surfaces[s].rgbFloatValues);
+    naFree(mesh->surfaces[s].normedSystemCoords);
+  }
+  mesh->surfaceCount = 0;
+  mesh->visibleCellCount = 0;
+
+  if(mesh->hasPointCloud){
+    naFree(mesh->pointRGB);
+    naFree(mesh->pointCoords);
+  }
+  mesh->hasPointCloud = NA_FALSE;
+  mesh->pointCount = 0;
+  mesh->pointCoords = NA_NULL;
+  mesh->pointRGB = NA_NULL;
+
+  mesh->valid = NA_FALSE;
+}
+
+
+
+void cpDeallocThreeDeeMesh(CPThreeDeeMesh* mesh){
+  cp_ClearThreeDeeMesh(mesh);
+  naFree(mesh);
+}
+
+
+
+static void cp_ComputeThreeDeeMeshSurfaces(
+  CPThreeDeeMesh* mesh,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  CMLNormedConverter normedInputConverter,
+  CMLColorConverter coordConverter,
+  CMLNormedConverter normedCoordConverter,
+  NAInt hueIndex){
+  CMLColorType space3D = mesh->colorType;
+  NAInt steps3D = mesh->steps3D;
+  size_t numChannels = cmlGetNumChannels(space3D);
+
+  CMLVec4UInt surfaceSteps[CP_THREEDEE_MAX_SURFACE_COUNT];
+  CMLVec4 origins[CP_THREEDEE_MAX_SURFACE_COUNT];
+  CMLVec4 axis1s[CP_THREEDEE_MAX_SURFACE_COUNT];
+  CMLVec4 axis2s[CP_THREEDEE_MAX_SURFACE_COUNT];
+
+  CPScratchArena* arena = cpGetThreadScratchArena();
+  size_t surfaceCount = 0;
+  switch(space3D){
+  case CML_COLOR_Gray:  surfaceCount = 0; break;
+  case CML_COLOR_HSL:   surfaceCount = 3; break;
+  case CML_COLOR_HSV:   surfaceCount = 2; break;
+  case CML_COLOR_Lab:   surfaceCount = 6; break;
+  case CML_COLOR_Lch:   surfaceCount = 3; break;
+  case CML_COLOR_Luv:   surfaceCount = 5; break;
+  case CML_COLOR_RGB:   surfaceCount = 6; break;
+  case CML_COLOR_UVW:   surfaceCount = 5; break;
+  case CML_COLOR_XYZ:   surfaceCount = 6; break;
+  case CML_COLOR_YCbCr: surfaceCount = 6; break;
+  case CML_COLOR_Ycd:   surfaceCount = 6; break;
+  case CML_COLOR_Yupvp: surfaceCount = 4; break;
+  case CML_COLOR_Yuv:   surfaceCount = 4; break;
+  case CML_COLOR_Yxy:   surfaceCount = 4; break;
+  default: break;
+  }
+
+  switch(space3D){
+  case CML_COLOR_Gray: break;
+  case CML_COLOR_HSL:
+    cmlSet4UInt(surfaceSteps[0], steps3D * 3 + 1, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D * 3 + 1, steps3D, 1, 1);
+    cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[1], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D * 3 + 1, 1, 1);
+    cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[2], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[2], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_HSV:
+    cmlSet4UInt(surfaceSteps[0], steps3D * 3 + 1, steps3D, 1, 1);
+    cmlSet4(origins[0], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[0], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D * 3 + 1, 1, 1);
+    cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[1], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[1], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_Lab:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_Lch:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D * 3 + 1, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D * 3 + 1, 1, 1);
+    cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[1], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D * 3 + 1, steps3D, 1, 1);
+    cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[2], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[2], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_Luv:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[1], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[1], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[2], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[2], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[3], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[4], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[4], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_RGB:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_UVW:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[1], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[1], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[2], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[2], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[3], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[4], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[4], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_XYZ:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_YCbCr:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_Ycd:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_Yupvp:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[1], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[2], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[2], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[3], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_Yuv:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[1], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[2], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[2], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[3], -1.f, 0.f, 0.f, 0.f);
+    break;
+  case CML_COLOR_Yxy:
+    cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis1s[0], 0.f, 0.f, 1.f, 0.f);
+    cmlSet4(axis2s[0], 1.f, 0.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[1], -1.f, 0.f, 0.f, 0.f);
+    cmlSet4(axis2s[1], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[2], 0.f, -1.f, 0.f, 0.f);
+    cmlSet4(axis2s[2], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
+    cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
+    cmlSet4(axis1s[3], 0.f, 0.f, -1.f, 0.f);
+    cmlSet4(axis2s[3], -1.f, 0.f, 0.f, 0.f);
+    break;
+  default: break;
+  }
+
+
+  for(size_t s = 0; s < surfaceCount; ++s){
+    CPThreeDeeSurface* surface = &(mesh->surfaces[s]);
+    surface->steps1 = surfaceSteps[s][0];
+    surface->steps2 = surfaceSteps[s][1];
+    size_t totalCount = surfaceSteps[s][0] * surfaceSteps[s][1] * surfaceSteps[s][2] * surfaceSteps[s][3];
+
+    size_t mark = cpGetScratchArenaMark(arena);
+    float* normedColorCoords = (float*)cmlCreateNormedGamutSlice(space3D, surfaceSteps[s], origins[s], axis1s[s], axis2s[s], NULL, NULL);
+    float* colorCoords = cpAllocScratch(arena, totalCount * numChannels * sizeof(float));
+    float* systemCoords = cpAllocScratch(arena, totalCount * 3 * sizeof(float));
+    surface->rgbFloatValues = naMalloc(totalCount * 3 * sizeof(float));
+    surface->normedSystemCoords = naMalloc(totalCount * 3 * sizeof(float));
+
+    normedInputConverter(colorCoords, normedColorCoords, totalCount);
+    coordConverter(cm, systemCoords, colorCoords, totalCount);
+    normedCoordConverter(surface->normedSystemCoords, systemCoords, totalCount);
+
+    // Convert the given values to screen RGBs. The same way as the point
+    // cloud such that points on the outline match the surfaces.
+    cpFillRGBFloatArrayWithLUT(
+      lutCache,
+      responseLUT,
+      mesh->machineGeneration,
+      cm,
+      sm,
+      surface->rgbFloatValues,
+      normedColorCoords,
+      space3D,
+      normedInputConverter,
+      totalCount);
+
+    // Cells spanning the hue discontinuity would be drawn across the whole
+    // body. They are marked once here instead of being tested every frame.
+    size_t cellCount = (surface->steps1 - 1) * (surface->steps2 - 1);
+    surface->cellVisible = naMalloc((cellCount ? cellCount : 1) * sizeof(NABool));
+    const float* coords = surface->normedSystemCoords;
+    for(size_t ax1 = 0; ax1 < surface->steps2 - 1; ax1++){
+      for(size_t ax2 = 0; ax2 < surface->steps1 - 1; ax2++){
+        NABool visible = NA_TRUE;
+        if(hueIndex >= 0){
+          size_t index0 = (ax1 + 0) * surface->steps1 * 3 + (ax2 + 0) * 3;
+          size_t index1 = (ax1 + 0) * surface->steps1 * 3 + (ax2 + 1) * 3;
+          size_t index2 = (ax1 + 1) * surface->steps1 * 3 + (ax2 + 1) * 3;
+          size_t index3 = (ax1 + 1) * surface->steps1 * 3 + (ax2 + 0) * 3;
+          if(    (fabsf(coords[index0 + hueIndex] - coords[index1 + hueIndex]) > .5f)
+              || (fabsf(coords[index0 + hueIndex] - coords[index2 + hueIndex]) > .5f)
+              || (fabsf(coords[index0 + hueIndex] - coords[index3 + hueIndex]) > .5f)){
+            visible = NA_FALSE;
+          }
+        }
+        surface->cellVisible[ax1 * (surface->steps1 - 1) + ax2] = visible;
+        if(visible){
+          mesh->visibleCellCount++;
+        }
+      }
+    }
+
+    cpResetScratchArena(arena, mark);
+    naFree(normedColorCoords);
+  }
+
+  mesh->surfaceCount = surfaceCount;
+}
+
+
+
+static void cp_ComputeThreeDeeMeshPointCloud(
+  CPThreeDeeMesh* mesh,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  CMLNormedConverter normedInputConverter,
+  CMLColorConverter coordConverter,
+  CMLNormedConverter normedCoordConverter){
+  CMLColorType space3D = mesh->colorType;
+  NAInt steps3D = mesh->steps3D;
+  size_t numChannels = cmlGetNumChannels(space3D);
+
+  CMLVec4UInt steps;
+  switch(space3D){
+  case CML_COLOR_Gray:  cmlSet4UInt(steps, 2 * steps3D, 1, 1, 1); break;
+  case CML_COLOR_HSL:   cmlSet4UInt(steps, 3 * steps3D + 1, steps3D, steps3D, 1); break;
+  case CML_COLOR_HSV:   cmlSet4UInt(steps, 3 * steps3D + 1, steps3D, steps3D, 1); break;
+  case CML_COLOR_Lab:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
+  case CML_COLOR_Lch:   cmlSet4UInt(steps, steps3D, steps3D, 3 * steps3D + 1, 1); break;
+  case CML_COLOR_Luv:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
+  case CML_COLOR_RGB:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
+  case CML_COLOR_UVW:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
+  case CML_COLOR_XYZ:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
+  case CML_COLOR_YCbCr: cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
+  case CML_COLOR_Yupvp: cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
+  case CML_COLOR_Yuv:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
+  case CML_COLOR_Yxy:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
+  default: cmlSet4UInt(steps, 1, 1, 1, 1); break;
+  }
+
+  CPScratchArena* arena = cpGetThreadScratchArena();
+  size_t mark = cpGetScratchArenaMark(arena);
+  size_t totalCloudCount = steps[0] * steps[1] * steps[2] * steps[3];
+  float* cloudNormedColorCoords = (float*)cmlCreateNormedGamutSlice(space3D, steps, NA_NULL, NA_NULL, NA_NULL, NA_NULL, NA_NULL);
+  float* cloudColorCoords = cpAllocScratch(arena, totalCloudCount * numChannels * sizeof(float));
+  float* cloudSystemCoords = cpAllocScratch(arena, totalCloudCount * 3 * sizeof(float));
+  mesh->pointRGB = naMalloc(totalCloudCount * 3 * sizeof(float));
+  mesh->pointCoords = naMalloc(totalCloudCount * 3 * sizeof(float));
+
+  normedInputConverter(cloudColorCoords, cloudNormedColorCoords, totalCloudCount);
+  coordConverter(cm, cloudSystemCoords, cloudColorCoords, totalCloudCount);
+  normedCoordConverter(mesh->pointCoords, cloudSystemCoords, totalCloudCount);
+
+  // Convert the given values to screen RGBs.
+  cpFillRGBFloatArrayWithLUT(
+    lutCache,
+    responseLUT,
+    mesh->machineGeneration,
+    cm,
+    sm,
+    mesh->pointRGB,
+    cloudNormedColorCoords,
+    space3D,
+    normedInputConverter,
+    totalCloudCount);
+
+  cpResetScratchArena(arena, mark);
+  naFree(cloudNormedColorCoords);
+
+  mesh->pointCount = totalCloudCount;
+  mesh->hasPointCloud = NA_TRUE;
+}
+
+
+
+void cpUpdateThreeDeeMesh(
+  CPThreeDeeMesh* mesh,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  CMLColorType colorType,
+  CoordSysType coordSysType,
+  NAInt steps3D,
+  size_t machineGeneration,
+  NABool withPointCloud,
+  CMLNormedConverter normedInputConverter,
+  CMLColorConverter coordConverter,
+  CMLNormedConverter normedCoordConverter,
+  NAInt hueIndex){
+  NABool upToDate = mesh->valid
+    && mesh->colorType == colorType
+    && mesh->coordSysType == coordSysType
+    && mesh->steps3D == steps3D
+    && mesh->machineGeneration == machineGeneration;
+
+  if(!upToDate){
+    cp_ClearThreeDeeMesh(mesh);
+    mesh->colorType = colorType;
+    mesh->coordSysType = coordSysType;
+    mesh->steps3D = steps3D;
+    mesh->machineGeneration = machineGeneration;
+    cp_ComputeThreeDeeMeshSurfaces(
+      mesh,
+      cm,
+      sm,
+      lutCache,
+      responseLUT,
+      normedInputConverter,
+      coordConverter,
+      normedCoordConverter,
+      hueIndex);
+    mesh->valid = NA_TRUE;
+    mesh->surfaceRevision++;
+  }
+
+  // The point cloud is only computed when it is visible.
+  if(withPointCloud && !mesh->hasPointCloud){
+    cp_ComputeThreeDeeMeshPointCloud(
+      mesh,
+      cm,
+      sm,
+      lutCache,
+      responseLUT,
+      normedInputConverter,
+      coordConverter,
+      normedCoordConverter);
+    mesh->pointRevision++;
+  }
+}
+
+
+
+size_t cpGetThreeDeeMeshSurfaceRevision(const CPThreeDeeMesh* mesh){
+  return mesh->surfaceRevision;
+}
+
+size_t cpGetThreeDeeMeshPointRevision(const CPThreeDeeMesh* mesh){
+  return mesh->pointRevision;
+}
+
+CMLColorType cpGetThreeDeeMeshColorType(const CPThreeDeeMesh* mesh){
+  return mesh->colorType;
+}
+
+size_t cpGetThreeDeeMeshSurfaceCount(const CPThreeDeeMesh* mesh){
+  return mesh->surfaceCount;
+}
+
+size_t cpGetThreeDeeMeshSurfaceSteps1(const CPThreeDeeMesh* mesh, size_t s){
+  return mesh->surfaces[s].steps1;
+}
+
+size_t cpGetThreeDeeMeshSurfaceSteps2(const CPThreeDeeMesh* mesh, size_t s){
+  return mesh->surfaces[s].steps2;
+}
+
+const float* cpGetThreeDeeMeshSurfaceCoords(const CPThreeDeeMesh* mesh, size_t s){
+  return mesh->surfaces[s].normedSystemCoords;
+}
+
+const float* cpGetThreeDeeMeshSurfaceRGB(const CPThreeDeeMesh* mesh, size_t s){
+  return mesh->surfaces[s].rgbFloatValues;
+}
+
+size_t cpGetThreeDeeMeshVisibleCellCount(const CPThreeDeeMesh* mesh){
+  return mesh->visibleCellCount;
+}
+
+NABool cpIsThreeDeeMeshCellVisible(const CPThreeDeeMesh* mesh, size_t s, size_t cellIndex){
+  return mesh->surfaces[s].cellVisible[cellIndex];
+}
+
+size_t cpGetThreeDeeMeshPointCount(const CPThreeDeeMesh* mesh){
+  return mesh->pointCount;
+}
+
+const float* cpGetThreeDeeMeshPointCoords(const CPThreeDeeMesh* mesh){
+  return mesh->pointCoords;
+}
+
+const float* cpGetThreeDeeMeshPointRGB(const CPThreeDeeMesh* mesh){
+  return mesh->pointRGB;
+}
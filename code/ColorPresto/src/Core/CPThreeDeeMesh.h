@@ -0,0 +1,65 @@
+
+#ifndef CP_THREEDEE_MESH_DEFINED
+#define CP_THREEDEE_MESH_DEFINED
+
+#include "../mainC.h"
+#include "CPColorLUT.h"
+#include "CPThreeDeeTypes.h"
+
+
+// The mesh holds the gamut surfaces and the point cloud of the 3D view in
+// normed system coordinates together with their screen RGB colors. It only
+// gets recomputed when one of its keys changes. Rotating or zooming the view
+// simply draws the cached geometry again.
+
+typedef struct CPThreeDeeMesh CPThreeDeeMesh;
+
+CPThreeDeeMesh* cpAllocThreeDeeMesh(void);
+void cpDeallocThreeDeeMesh(CPThreeDeeMesh* mesh);
+
+// Recomputes the surfaces and, if requested, the point cloud in case any of
+// colorType, coordSysType, steps3D or machineGeneration differs from the
+// values the mesh had been computed with. The colors of the surfaces and of
+// the point cloud are evaluated with lutCache and responseLUT, see
+// cpFillRGBFloatArrayWithLUT. The coordinates are always converted exactly.
+void cpUpdateThreeDeeMesh(
+  CPThreeDeeMesh* mesh,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  CPColorLUTCache* lutCache,
+  CPResponseLUT* responseLUT,
+  CMLColorType colorType,
+  CoordSysType coordSysType,
+  NAInt steps3D,
+  size_t machineGeneration,
+  NABool withPointCloud,
+  CMLNormedConverter normedInputConverter,
+  CMLColorConverter coordConverter,
+  CMLNormedConverter normedCoordConverter,
+  NAInt hueIndex);
+
+// Increase every time the surfaces or the point cloud respectively have been
+// recomputed. Computing the point cloud leaves the surfaces untouched.
+size_t cpGetThreeDeeMeshSurfaceRevision(const CPThreeDeeMesh* mesh);
+size_t cpGetThreeDeeMeshPointRevision(const CPThreeDeeMesh* mesh);
+
+CMLColorType cpGetThreeDeeMeshColorType(const CPThreeDeeMesh* mesh);
+
+size_t cpGetThreeDeeMeshSurfaceCount(const CPThreeDeeMesh* mesh);
+size_t cpGetThreeDeeMeshSurfaceSteps1(const CPThreeDeeMesh* mesh, size_t s);
+size_t cpGetThreeDeeMeshSurfaceSteps2(const CPThreeDeeMesh* mesh, size_t s);
+const float* cpGetThreeDeeMeshSurfaceCoords(const CPThreeDeeMesh* mesh, size_t s);
+const float* cpGetThreeDeeMeshSurfaceRGB(const CPThreeDeeMesh* mesh, size_t s);
+// Number of cells of all surfaces for which cpIsThreeDeeMeshCellVisible
+// returns true, counted once when the surfaces are computed.
+size_t cpGetThreeDeeMeshVisibleCellCount(const CPThreeDeeMesh* mesh);
+// Returns false for a cell which wraps around the hue axis and must not be drawn.
+NABool cpIsThreeDeeMeshCellVisible(const CPThreeDeeMesh* mesh, size_t s, size_t cellIndex);
+
+size_t cpGetThreeDeeMeshPointCount(const CPThreeDeeMesh* mesh);
+const float* cpGetThreeDeeMeshPointCoords(const CPThreeDeeMesh* mesh);
+const float* cpGetThreeDeeMeshPointRGB(const CPThreeDeeMesh* mesh);
+
+
+
+#endif // CP_THREEDEE_MESH_DEFINED
@@ -0,0 +1,41 @@
+
+#ifndef CP_UV_METAMERIC_INDEX_DEFINED
+#define CP_UV_METAMERIC_INDEX_DEFINED
+
+#include "CPColorConversionsYcdUVW.h"
+#include "../mainC.h"
+
+CP_PROTOTYPE(CPSpectralMatrix);
+CP_PROTOTYPE(CPSpectralWeights);
+CP_PROTOTYPE(CPWhitePoints);
+
+
+
+// /////////////////////
+// ISO 3664 2009 D.4.3 Ultraviolet range metameric index
+// /////////////////////
+
+typedef struct CPUVMetamericColors CPUVMetamericColors;
+struct CPUVMetamericColors{
+  CMLVec3 uvStandardRGBFloatData[3];
+  CMLVec3 uvMetamerRGBFloatData[3];
+  float metamericIndex[3];
+  float avg3;
+};
+
+// Allocates the matrix holding all remissions needed for the index.
+CPSpectralMatrix* cpAllocUVMetamericMatrix(void);
+
+CPUVMetamericColors cpComputeUVMetamericColors(
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  const CPSpectralMatrix* metamerMatrix,
+  const CPSpectralWeights* illWeights10,
+  const CPSpectralWeights* observerWeights10,
+  const CPWhitePoints* illWhitePoint10,
+  CPReferenceIlluminationType referenceIlluminationType);
+
+
+
+#endif // CP_UV_METAMERIC_INDEX_DEFINED
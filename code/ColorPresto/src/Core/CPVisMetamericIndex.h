@@ -0,0 +1,41 @@
+
+#ifndef CP_VIS_METAMERIC_INDEX_DEFINED
+#define CP_VIS_METAMERIC_INDEX_DEFINED
+
+#include "CPColorConversionsYcdUVW.h"
+#include "../mainC.h"
+
+CP_PROTOTYPE(CPSpectralMatrix);
+CP_PROTOTYPE(CPSpectralWeights);
+CP_PROTOTYPE(CPWhitePoints);
+
+
+
+// /////////////////////
+// ISO 3664 2009 D.4.3 Visible range metameric index
+// /////////////////////
+
+typedef struct CPVisMetamericColors CPVisMetamericColors;
+struct CPVisMetamericColors{
+  CMLVec3 visStandardRGBFloatData[5];
+  CMLVec3 visMetamerRGBFloatData[5];
+  float metamericIndex[5];
+  float avg5;
+};
+
+// Allocates the matrix holding all remissions needed for the index.
+CPSpectralMatrix* cpAllocVisMetamericMatrix(void);
+
+CPVisMetamericColors cpComputeVisMetamericColors(
+  size_t machineGeneration,
+  const CMLColorMachine* cm,
+  const CMLColorMachine* sm,
+  const CPSpectralMatrix* metamerMatrix,
+  const CPSpectralWeights* illWeights10,
+  const CPWhitePoints* illWhitePoint10,
+  const CMLMat33 adaptationMatrix,
+  CPReferenceIlluminationType referenceIlluminationType);
+
+
+
+#endif // CP_VIS_METAMERIC_INDEX_DEFINED
@@ -2,15 +2,12 @@
 #include "CPWhitePoints.h"
 
 #include "CPColorConversionsYcdUVW.h"
-#include "../CPColorPrestoApplication.h"
 #include "../mainC.h"
 
 
 
-void cp_FillChromaticAdaptationMatrix(CMLMat33 adaptationMatrix, const CMLVec3 whitePointYxy10)
+void cp_FillChromaticAdaptationMatrix(CMLMat33 adaptationMatrix, const CMLColorMachine* sm, const CMLVec3 whitePointYxy10)
 {
-  CMLColorMachine* sm = cpGetCurrentScreenMachine();
-
   // Note that the use of a chromatic adaptation is purely for displaying
   // reasons and is not in the ISO-standard at all. The differences between
   // the colors can be seen better when using the 10 deg observer. That's all.
@@ -21,6 +21,7 @@ struct CPWhitePoints{
 
 void cp_FillChromaticAdaptationMatrix(
   CMLMat33 adaptationMatrix,
+  const CMLColorMachine* sm,
   const CMLVec3 whitePointYxy10);
   
 CPWhitePoints cpGetWhitePoints(
@@ -27,7 +27,7 @@ void cp_PressMachineButton(NAReaction reaction){
   
   if(reaction.uiElement == con->resetMachineButton){
     cpResetColorMachine();
-    cpUpdateMachine();
+    cpUpdateMachine(CP_CHANGE_MACHINE);
   }else if(reaction.uiElement == con->metamericsButton){
     cpShowMetamerics();
   }else if(reaction.uiElement == con->threeDeeButton){
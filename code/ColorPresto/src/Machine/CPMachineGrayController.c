@@ -22,12 +22,13 @@ struct CPMachineGrayController{
 void cp_SelectGrayColorSpace(NAReaction reaction){
   CPMachineGrayController* con = (CPMachineGrayController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   size_t index = naGetSelectItemIndex(con->grayColorSpaceSelect, reaction.uiElement);
   CMLGrayComputationType grayComputationType = (CMLGrayComputationType)index;
   cmlSetGrayComputationType(cm, grayComputationType);
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_GRAY);
 }
 
 
@@ -31,6 +31,7 @@ struct CPMachineIlluminationController{
 void cp_SelectIllumination(NAReaction reaction){
   CPMachineIlluminationController* con = (CPMachineIlluminationController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   size_t index = naGetSelectItemIndex(con->illuminationSelect, reaction.uiElement);
   CMLIlluminationType illuminationType = (CMLIlluminationType)index;
@@ -44,7 +45,7 @@ void cp_SelectIllumination(NAReaction reaction){
     cmlSetIlluminationType(cm, (CMLIlluminationType)index);
   }
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_ILLUMINATION);
 }
 
 
@@ -52,6 +53,7 @@ void cp_SelectIllumination(NAReaction reaction){
 void cpSetIlluminationTemperature(NAReaction reaction){
   CPMachineIlluminationController* con = (CPMachineIlluminationController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   float temperature = 0.f;
   if(reaction.uiElement == con->illuminationTemperatureTextField){
@@ -64,7 +66,7 @@ void cpSetIlluminationTemperature(NAReaction reaction){
   }
   cmlSetIlluminationTemperature(cm, temperature);
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_ILLUMINATION);
 }
 
 
@@ -72,13 +74,13 @@ void cpSetIlluminationTemperature(NAReaction reaction){
 void cpSetWhitePoint(NAReaction reaction){
   CPMachineIlluminationController* con = (CPMachineIlluminationController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   CMLVec3 whitePointYxy;
   cmlCpy3(whitePointYxy, cmlGetWhitePointYxy(cm));
   
   if(reaction.uiElement == con->setWhitePointButton){
-    CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_Yxy, cpGetCurrentColorType());
-    converter(cm, whitePointYxy, cpGetCurrentColorData(), 1);
+    cmlCpy3(whitePointYxy, cpGetCurrentColorYxy());
   }else if(reaction.uiElement == con->whitePointYTextField){
     whitePointYxy[0] = (float)naGetTextFieldDouble(con->whitePointYTextField);
   }else if(reaction.uiElement == con->whitePointxTextField){
@@ -88,7 +90,7 @@ void cpSetWhitePoint(NAReaction reaction){
   }
   cmlSetReferenceWhitePointYxy(cm, whitePointYxy);
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_ILLUMINATION);
 }
 
 
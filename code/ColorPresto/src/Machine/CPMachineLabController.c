@@ -30,13 +30,14 @@ struct CPMachineLabController{
 void cp_SelectLabColorSpace(NAReaction reaction){
   CPMachineLabController* con = (CPMachineLabController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   size_t index = naGetSelectItemIndex(con->labColorSpaceSelect, reaction.uiElement);
   CMLLabColorSpaceType labColorSpaceType = (CMLLabColorSpaceType)index;
   if(labColorSpaceType >= CML_LAB_CUSTOM_L){++labColorSpaceType;}
   cmlSetLabColorSpace(cm, labColorSpaceType);
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_LAB);
 }
 
 
@@ -44,6 +45,7 @@ void cp_SelectLabColorSpace(NAReaction reaction){
 void cpSetLabValue(NAReaction reaction){
   CPMachineLabController* con = (CPMachineLabController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   float K;
   float ke;
@@ -60,7 +62,7 @@ void cpSetLabValue(NAReaction reaction){
   }
   cmlSetAdamsChromaticityValenceParameters(cm, K, ke);
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_LAB);
 }
 
 
@@ -3,6 +3,7 @@
 
 #include "../CPColorPrestoApplication.h"
 #include "../CPDesign.h"
+#include "../CPSpectralCache.h"
 #include "../CPTranslations.h"
 
 #include "NAApp/NAApp.h"
@@ -23,11 +24,12 @@ struct CPMachineObserverController{
 void cp_SelectObserver(NAReaction reaction){
   CPMachineObserverController* con = (CPMachineObserverController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   size_t index = naGetSelectItemIndex(con->observerSelect, reaction.uiElement);
   cmlSetObserverType(cm, (CMLObserverType)index);
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_OBSERVER);
 }
 
 
@@ -79,10 +81,10 @@ void cpUpdateMachineObserverController(CPMachineObserverController* con){
   CMLColorMachine* cm = cpGetCurrentColorMachine();
 
   CMLObserverType observerType = cmlGetObserverType(cm);
-  CMLFunction* specDistFunctions[3];
+  CMLFunction** specDistFunctions = cpRetainObserverFunctions(observerType);
   CMLDefinitionRange defRange;
-  cmlCreateSpecDistFunctions(specDistFunctions, observerType);
   cmlGetFunctionDefinitionRange(specDistFunctions[0], &defRange);
+  cpReleaseObserverFunctions(observerType);
 
   naSetSelectIndexSelected(con->observerSelect, observerType);
   naSetLabelText(
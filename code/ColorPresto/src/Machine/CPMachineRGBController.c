@@ -60,12 +60,13 @@ struct CPMachineRGBController{
 void cp_SelectRGBColorSpace(NAReaction reaction){
   CPMachineRGBController* con = (CPMachineRGBController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   size_t index = naGetSelectItemIndex(con->rgbColorSpaceSelect, reaction.uiElement);
   CMLRGBColorSpaceType rgbColorSpaceType = (CMLRGBColorSpaceType)index;
   cmlSetRGBColorSpaceType(cm, rgbColorSpaceType);
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_RGB_PRIMARIES | CP_CHANGE_RESPONSE | CP_CHANGE_ILLUMINATION);
 }
 
 
@@ -73,27 +74,25 @@ void cp_SelectRGBColorSpace(NAReaction reaction){
 void cpSetRGBYxy(NAReaction reaction){
   CPMachineRGBController* con = (CPMachineRGBController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   CMLVec3 primaries[3];
   cmlGetRGBPrimariesYxy(cm, primaries);
 
   if(reaction.uiElement == con->setPrimaryRButton){
-    CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_Yxy, cpGetCurrentColorType());
-    converter(cm, primaries[0], cpGetCurrentColorData(), 1);
+    cmlCpy3(primaries[0], cpGetCurrentColorYxy());
   }else if(reaction.uiElement == con->redPointxTextField){
     primaries[0][1] = (float)naGetTextFieldDouble(con->redPointxTextField);
   }else if(reaction.uiElement == con->redPointyTextField){
     primaries[0][2] = (float)naGetTextFieldDouble(con->redPointyTextField);
   }else if(reaction.uiElement == con->setPrimaryGButton){
-    CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_Yxy, cpGetCurrentColorType());
-    converter(cm, primaries[1], cpGetCurrentColorData(), 1);
+    cmlCpy3(primaries[1], cpGetCurrentColorYxy());
   }else if(reaction.uiElement == con->greenPointxTextField){
     primaries[1][1] = (float)naGetTextFieldDouble(con->greenPointxTextField);
   }else if(reaction.uiElement == con->greenPointyTextField){
     primaries[1][2] = (float)naGetTextFieldDouble(con->greenPointyTextField);
   }else if(reaction.uiElement == con->setPrimaryBButton){
-    CMLColorConverter converter = cmlGetColorConverter(CML_COLOR_Yxy, cpGetCurrentColorType());
-    converter(cm, primaries[2], cpGetCurrentColorData(), 1);
+    cmlCpy3(primaries[2], cpGetCurrentColorYxy());
   }else if(reaction.uiElement == con->bluePointxTextField){
     primaries[2][1] = (float)naGetTextFieldDouble(con->bluePointxTextField);
   }else if(reaction.uiElement == con->bluePointyTextField){
@@ -101,7 +100,7 @@ void cpSetRGBYxy(NAReaction reaction){
   }
   cmlSetRGBPrimariesYxy(cm, primaries);
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_RGB_PRIMARIES);
 }
 
 
@@ -109,6 +108,7 @@ void cpSetRGBYxy(NAReaction reaction){
 void cp_SelectRGBChannel(NAReaction reaction){
   CPMachineRGBController* con = (CPMachineRGBController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   size_t newSelectedChannel = naGetSelectItemIndex(con->rgbResponseChannelsSelect, reaction.uiElement);
 
@@ -144,7 +144,7 @@ void cp_SelectRGBChannel(NAReaction reaction){
   }
   con->lastSelectedChannel = newSelectedChannel;
     
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_RESPONSE);
 }
 
 
@@ -152,6 +152,7 @@ void cp_SelectRGBChannel(NAReaction reaction){
 void cp_SelectRGBResponse(NAReaction reaction){
   CPMachineRGBController* con = (CPMachineRGBController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   size_t index = naGetSelectItemIndex(con->rgbResponseSelect, reaction.uiElement);
   // CML_RESPONSE_UNDEFINED must be overjumped
@@ -178,7 +179,7 @@ void cp_SelectRGBResponse(NAReaction reaction){
   cmlClearResponseCurve(newResponse);
   free(newResponse);
   
-  cpUpdateMachine();
+  cpUpdateMachine(CP_CHANGE_RESPONSE);
 }
 
 
@@ -186,6 +187,7 @@ void cp_SelectRGBResponse(NAReaction reaction){
 void cpSetResponseValue(NAReaction reaction){
   CPMachineRGBController* con = (CPMachineRGBController*)reaction.controller;
   CMLColorMachine* cm = cpGetCurrentColorMachine();
+  cpCancelUpdates();
 
   size_t colorIndex = con->lastSelectedChannel;
   if(colorIndex > 0){ colorIndex--; }
@@ -242,7 +244,11 @@ void cpSetResponseValue(NAReaction reaction){
   free(newResponseG);
   free(newResponseB);
 
-  cpUpdateMachine();
+  // Redraw the curves right away. Only the channels whose parameters the
+  // slider changed get evaluated anew.
+  cpUpdateGammaDisplayController(con->gammaDisplayController);
+
+  cpUpdateMachine(CP_CHANGE_RESPONSE);
 }
 
 
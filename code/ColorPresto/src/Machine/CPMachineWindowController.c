@@ -3,6 +3,7 @@
 
 #include "CPMachineController.h"
 #include "../ColorControllers/CPColorController.h"
+#include "../CPColorPrestoApplication.h"
 #include "../CPDesign.h"
 #include "../CPTranslations.h"
 
@@ -19,7 +20,6 @@
 
 #include "NAApp/NAApp.h"
 #include "NAUtility/NAMemory.h"
-#include "NAUtility/NAThreading.h"
 
 
 
@@ -143,33 +143,25 @@ CPColorController* cpGetInitialColorController(CPMachineWindowController* con){
 
 
 
-void cpUpdateMachineWindowController(CPMachineWindowController* con){
-  // Compute the controller data with threads
-  NAThread GrayThread     = naMakeThread("Compute Gray",      (NAMutator)cpComputeGrayColorController,     con->grayColorController);
-  NAThread HSVHSLThread   = naMakeThread("Compute HSV/HSL",   (NAMutator)cpComputeHSVHSLColorController,   con->hsvhslColorController);
-  NAThread LabLchThread   = naMakeThread("Compute Lab/Lch",   (NAMutator)cpComputeLabLchColorController,   con->lablchColorController);
-  NAThread LuvUVWThread   = naMakeThread("Compute Luv/UVW",   (NAMutator)cpComputeLuvUVWColorController,   con->luvuvwColorController);
-  NAThread RGBThread      = naMakeThread("Compute RGB",       (NAMutator)cpComputeRGBColorController,      con->rgbColorController);
-  NAThread SpectralThread = naMakeThread("Compute Spectral",  (NAMutator)cpComputeSpectralColorController, con->spectralColorController);
-  NAThread XYZThread      = naMakeThread("Compute XYZ",       (NAMutator)cpComputeXYZColorController,      con->xyzColorController);
-  NAThread YCbCrThread    = naMakeThread("Compute YCbCr",     (NAMutator)cpComputeYCbCrColorController,    con->ycbcrColorController);
-  NAThread YuvYupvpThread = naMakeThread("Compute Yuv/Yupvp", (NAMutator)cpComputeYuvYupvpColorController, con->yuvyupvpColorController);
-  NAThread YyxThread      = naMakeThread("Compute Yxy",       (NAMutator)cpComputeYxyColorController,      con->yxyColorController);
-
-  // Start all threads.
-  naRunThread(GrayThread);
-  naRunThread(HSVHSLThread);
-  naRunThread(LabLchThread);
-  naRunThread(LuvUVWThread);
-  naRunThread(RGBThread);
-  naRunThread(SpectralThread);
-  naRunThread(XYZThread);
-  naRunThread(YCbCrThread);
-  naRunThread(YuvYupvpThread);
-  naRunThread(YyxThread);
+void cpComputeMachineWindowController(CPMachineWindowController* con, CPWorkerPool* pool, NABool machineChanged){
+  // Convert the current color for every controller and add their color wells
+  // to the worker pool. The spectral controller comes first as the others
+  // may read its monochromatic XYZ.
+  cpComputeSpectralColorController(con->spectralColorController, pool);
+  cpComputeGrayColorController(con->grayColorController, pool);
+  cpComputeHSVHSLColorController(con->hsvhslColorController, pool);
+  cpComputeLabLchColorController(con->lablchColorController, pool);
+  cpComputeLuvUVWColorController(con->luvuvwColorController, pool);
+  cpComputeRGBColorController(con->rgbColorController, pool);
+  cpComputeXYZColorController(con->xyzColorController, pool);
+  cpComputeYCbCrColorController(con->ycbcrColorController, pool);
+  cpComputeYuvYupvpColorController(con->yuvyupvpColorController, pool);
+  cpComputeYxyColorController(con->yxyColorController, pool);
 
   // In the meantime, update the machine
-  cpUpdateMachineController(con->machineController);
+  if(machineChanged){
+    cpUpdateMachineController(con->machineController);
+  }
 
   cpSetColorControllerActive((CPColorController*)con->grayColorController, cpGetCurrentColorController() == (CPColorController*)con->grayColorController);
   cpSetColorControllerActive((CPColorController*)con->hsvhslColorController, cpGetCurrentColorController() == (CPColorController*)con->hsvhslColorController);
@@ -181,19 +173,11 @@ void cpUpdateMachineWindowController(CPMachineWindowController* con){
   cpSetColorControllerActive((CPColorController*)con->ycbcrColorController, cpGetCurrentColorController() == (CPColorController*)con->ycbcrColorController);
   cpSetColorControllerActive((CPColorController*)con->yuvyupvpColorController, cpGetCurrentColorController() == (CPColorController*)con->yuvyupvpColorController);
   cpSetColorControllerActive((CPColorController*)con->yxyColorController, cpGetCurrentColorController() == (CPColorController*)con->yxyColorController);
+}
 
-  // Await all threads before updating the color controller UIs
-  naAwaitThread(GrayThread);
-  naAwaitThread(HSVHSLThread);
-  naAwaitThread(LabLchThread);
-  naAwaitThread(LuvUVWThread);
-  naAwaitThread(RGBThread);
-  naAwaitThread(SpectralThread);
-  naAwaitThread(XYZThread);
-  naAwaitThread(YCbCrThread);
-  naAwaitThread(YuvYupvpThread);
-  naAwaitThread(YyxThread);
 
+
+void cpUpdateMachineWindowController(CPMachineWindowController* con){
   cpUpdateGrayColorController(con->grayColorController);
   cpUpdateHSVHSLColorController(con->hsvhslColorController);
   cpUpdateLabLchColorController(con->lablchColorController);
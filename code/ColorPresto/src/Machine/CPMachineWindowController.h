@@ -3,6 +3,7 @@
 
 #include "../mainC.h"
 CP_PROTOTYPE(CPColorController);
+CP_PROTOTYPE(CPWorkerPool);
 
 
 
@@ -13,6 +14,10 @@ void cpDeallocMachineWindowController(CPMachineWindowController* con);
 
 void cpShowMachineWindowController(CPMachineWindowController* con);
 CPColorController* cpGetInitialColorController(CPMachineWindowController* con);
+// Adds the color wells of all controllers to the pool and, if the machine
+// changed, updates the machine settings. Once the pool is done,
+// cpUpdateMachineWindowController shows the results.
+void cpComputeMachineWindowController(CPMachineWindowController* con, CPWorkerPool* pool, NABool machineChanged);
 void cpUpdateMachineWindowController(CPMachineWindowController* con);
 
 
@@ -3,7 +3,7 @@
 
 #include "../CPDesign.h"
 #include "../CPTranslations.h"
-#include "CPWhitePoints.h"
+#include "../Core/CPWhitePoints.h"
 
 #include "NAApp/NAApp.h"
 #include "NAUtility/NABinaryData.h"
@@ -1,6 +1,7 @@
 
 #include "../mainC.h"
 
+CP_PROTOTYPE(CPSpectralWeights);
 CP_PROTOTYPE(CPWhitePoints);
 CP_PROTOTYPE(NASpace);
 
@@ -19,7 +20,8 @@ NASpace* cpGetColorRenderingIndexUIElement(CPColorRenderingIndexController* con)
 
 void cpUpdateColorRenderingIndexController(
   CPColorRenderingIndexController* con,
-  CMLFunction* observer2Funcs[3],
+  const CPSpectralWeights* illWeights2,
+  const CPSpectralWeights* refWeights2,
   const CPWhitePoints* illWhitePoint2,
   const CPWhitePoints* refWhitePoint2,
   const CMLFunction* refSpec,
@@ -5,16 +5,18 @@
 #include "../CPTranslations.h"
 #include "../mainC.h"
 #include "../CPDesign.h"
+#include "../CPSpectralCache.h"
 
 #include "CPChromaticityErrorController.h"
 #include "CPWhitePointsController.h"
-#include "CPColorConversionsYcdUVW.h"
+#include "../Core/CPColorConversionsYcdUVW.h"
 #include "CPColorRenderingIndexController.h"
+#include "../Core/CPSpectralMatrix.h"
 #include "CPTwoColorController.h"
 #include "CPTotalMetamericIndexController.h"
 #include "CPUVMetamericIndexController.h"
 #include "CPVisMetamericIndexController.h"
-#include "CPWhitePoints.h"
+#include "../Core/CPWhitePoints.h"
 #include "CML.h"
 
 #include "NAApp/NAApp.h"
@@ -34,6 +36,12 @@ struct CPMetamericsController{
   CPVisMetamericIndexController* visMetamericIndexController;
   CPUVMetamericIndexController* uvMetamericIndexController;
   CPTotalMetamericIndexController* totalMetamericIndexController;
+
+  // Illumination times observer weights shared by all metameric indices.
+  CPSpectralWeights* illWeights10;
+  CPSpectralWeights* illWeights2;
+  CPSpectralWeights* refWeights2;
+  CPSpectralWeights* observerWeights10;
 };
 
 
@@ -48,6 +56,11 @@ CPMetamericsController* cpAllocMetamericsController(void){
   con->uvMetamericIndexController = cpAllocUVMetamericIndexController();
   con->totalMetamericIndexController = cpAllocTotalMetamericIndexController();
 
+  con->illWeights10 = cpAllocSpectralWeights();
+  con->illWeights2 = cpAllocSpectralWeights();
+  con->refWeights2 = cpAllocSpectralWeights();
+  con->observerWeights10 = cpAllocSpectralWeights();
+
   NASpace* whitePointsSpace = cpGetWhitePointsUIElement(con->whitePointsController);
   NASpace* chromaticityErrorSpace = cpGetChromaticityErrorUIElement(con->chromaticityErrorController);
   NASpace* colorRenderingIndexSpace = cpGetColorRenderingIndexUIElement(con->colorRenderingIndexController);
@@ -115,6 +128,11 @@ void cpDeallocMetamericsController(CPMetamericsController* con){
   cpDeallocUVMetamericIndexController(con->uvMetamericIndexController);
   cpDeallocTotalMetamericIndexController(con->totalMetamericIndexController);
 
+  cpDeallocSpectralWeights(con->illWeights10);
+  cpDeallocSpectralWeights(con->illWeights2);
+  cpDeallocSpectralWeights(con->refWeights2);
+  cpDeallocSpectralWeights(con->observerWeights10);
+
   naFree(con);
 }
 
@@ -129,33 +147,32 @@ void cpShowMetamericsController(CPMetamericsController* con){
 void cpUpdateMetamericsController(CPMetamericsController* con){
   CMLColorMachine* cm = cpGetCurrentColorMachine();
 
-  CMLFunction* observer10Funcs[3];
-  cmlCreateSpecDistFunctions(observer10Funcs, CML_DEFAULT_10DEG_OBSERVER);
-  CMLFunction* observer2Funcs[3];
-  cmlCreateSpecDistFunctions(observer2Funcs, CML_DEFAULT_2DEG_OBSERVER);
+  CMLFunction** observer10Funcs = cpRetainObserverFunctions(CML_DEFAULT_10DEG_OBSERVER);
+  CMLFunction** observer2Funcs = cpRetainObserverFunctions(CML_DEFAULT_2DEG_OBSERVER);
   const CMLFunction* illuminationSpec = cmlGetIlluminationSpectrum(cm);
   CPReferenceIlluminationType referenceIlluminationType = cpGetReferenceIlluminationType(con->whitePointsController);
 
-  const CMLFunction* ref;
+  CMLIlluminationType refType;
   switch(referenceIlluminationType){
   case REFERENCE_ILLUMINATION_D50:
-    ref = cmlCreateIlluminationSpectrum(CML_ILLUMINATION_D50, 0.f);
+    refType = CML_ILLUMINATION_D50;
     break;
   case REFERENCE_ILLUMINATION_D55:
-    ref = cmlCreateIlluminationSpectrum(CML_ILLUMINATION_D55, 0.f);
+    refType = CML_ILLUMINATION_D55;
     break;
   case REFERENCE_ILLUMINATION_D65:
-    ref = cmlCreateIlluminationSpectrum(CML_ILLUMINATION_D65, 0.f);
+    refType = CML_ILLUMINATION_D65;
     break;
   case REFERENCE_ILLUMINATION_D75:
-    ref = cmlCreateIlluminationSpectrum(CML_ILLUMINATION_D75, 0.f);
+    refType = CML_ILLUMINATION_D75;
     break;
   default:
     #if NA_DEBUG
       cpError("This shoud not happen.");
     #endif
-    ref = cmlCreateIlluminationSpectrum(CML_ILLUMINATION_D50, 0.f);
+    refType = CML_ILLUMINATION_D50;
   }
+  const CMLFunction* ref = cpRetainIlluminationSpectrum(refType, 0.f);
 
   CPWhitePoints illWhitePoint10 = cpGetWhitePoints(
     illuminationSpec,
@@ -175,7 +192,14 @@ void cpUpdateMetamericsController(CPMetamericsController* con){
     observer2Funcs);
 
   CMLMat33 adaptationMatrix;
-  cp_FillChromaticAdaptationMatrix(adaptationMatrix, illWhitePoint10.Yxy);
+  cp_FillChromaticAdaptationMatrix(adaptationMatrix, cpGetCurrentScreenMachine(), illWhitePoint10.Yxy);
+
+  if(illuminationSpec){
+    cpFillSpectralWeights(con->illWeights10, illuminationSpec, observer10Funcs);
+    cpFillSpectralWeights(con->illWeights2, illuminationSpec, observer2Funcs);
+    cpFillSpectralWeights(con->refWeights2, ref, observer2Funcs);
+    cpFillSpectralWeights(con->observerWeights10, NA_NULL, observer10Funcs);
+  }
 
 
 
@@ -194,7 +218,8 @@ void cpUpdateMetamericsController(CPMetamericsController* con){
     
   cpUpdateColorRenderingIndexController(
     con->colorRenderingIndexController,
-    observer2Funcs,
+    con->illWeights2,
+    con->refWeights2,
     &illWhitePoint2,
     &refWhitePoint2,
     ref,
@@ -202,7 +227,7 @@ void cpUpdateMetamericsController(CPMetamericsController* con){
 
   cpUpdateVisMetamericIndexController(
     con->visMetamericIndexController,
-    observer10Funcs,
+    con->illWeights10,
     &illWhitePoint10,
     adaptationMatrix,
     referenceIlluminationType,
@@ -210,7 +235,8 @@ void cpUpdateMetamericsController(CPMetamericsController* con){
 
   cpUpdateUVMetamericIndexController(
     con->uvMetamericIndexController,
-    observer10Funcs,
+    con->illWeights10,
+    con->observerWeights10,
     &illWhitePoint10,
     referenceIlluminationType,
     illuminationSpec != NA_NULL);
@@ -223,7 +249,7 @@ void cpUpdateMetamericsController(CPMetamericsController* con){
 
 
 
-  cmlReleaseFunction(observer10Funcs[0]);
-  cmlReleaseFunction(observer10Funcs[1]);
-  cmlReleaseFunction(observer10Funcs[2]);
+  cpReleaseIlluminationSpectrum(refType, 0.f);
+  cpReleaseObserverFunctions(CML_DEFAULT_2DEG_OBSERVER);
+  cpReleaseObserverFunctions(CML_DEFAULT_10DEG_OBSERVER);
 }
@@ -1,7 +1,7 @@
 
 #include "CPTotalMetamericIndexController.h"
 
-#include "CPColorConversionsYcdUVW.h"
+#include "../Core/CPColorConversionsYcdUVW.h"
 #include "../CPDesign.h"
 #include "../CPTranslations.h"
 
@@ -1,10 +1,10 @@
 
-#include "CPColorConversionsYcdUVW.h"
+#include "../Core/CPColorConversionsYcdUVW.h"
 #include "CPMetamericsController.h"
 
 #include "../mainC.h"
 
-CP_PROTOTYPE(CMLFunction);
+CP_PROTOTYPE(CPSpectralWeights);
 CP_PROTOTYPE(CPWhitePoints);
 CP_PROTOTYPE(NASpace);
 
@@ -24,7 +24,8 @@ float cpGetUVMetamericIndexAverage(CPUVMetamericIndexController* con);
 
 void cpUpdateUVMetamericIndexController(
   CPUVMetamericIndexController* con,
-  CMLFunction* observer10Funcs[3],
+  const CPSpectralWeights* illWeights10,
+  const CPSpectralWeights* observerWeights10,
   const CPWhitePoints* illWhitePoint10,
   CPReferenceIlluminationType referenceIlluminationType,
   NABool valid);
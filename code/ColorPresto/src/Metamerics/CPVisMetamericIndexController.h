@@ -1,9 +1,10 @@
 
-#include "CPColorConversionsYcdUVW.h"
+#include "../Core/CPColorConversionsYcdUVW.h"
 #include "CPMetamericsController.h"
 
 #include "../mainC.h"
 
+CP_PROTOTYPE(CPSpectralWeights);
 CP_PROTOTYPE(CPWhitePoints);
 CP_PROTOTYPE(NASpace);
 
@@ -23,7 +24,7 @@ float cpGetVisMetamericIndexAverage(CPVisMetamericIndexController* con);
 
 void cpUpdateVisMetamericIndexController(
   CPVisMetamericIndexController* con,
-  CMLFunction* observer10Funcs[3],
+  const CPSpectralWeights* illWeights10,
   const CPWhitePoints* illWhitePoint10,
   const CMLMat33 adaptationMatrix,
   CPReferenceIlluminationType referenceIlluminationType,
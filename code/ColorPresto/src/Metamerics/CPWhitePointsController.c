@@ -5,7 +5,7 @@
 #include "../CPDesign.h"
 #include "CPMetamericsController.h"
 #include "../CPTranslations.h"
-#include "CPWhitePoints.h"
+#include "../Core/CPWhitePoints.h"
 
 #include "CML.h"
 
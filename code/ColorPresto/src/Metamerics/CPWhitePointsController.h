@@ -1,6 +1,6 @@
 
 #include "../mainC.h"
-#include "CPColorConversionsYcdUVW.h"
+#include "../Core/CPColorConversionsYcdUVW.h"
 
 CP_PROTOTYPE(CPWhitePoints);
 CP_PROTOTYPE(NASpace);
@@ -8,6 +8,13 @@ enum{
   CPLuvUVWSelection,
   CPLabLchSelection,
   CPYuvYupvpSelection,
+
+  CPThreeDeeRendererSelection,
+
+  CPColorLUTSelection,
+  CPWellDitherSelection,
+  CPProgressiveWellsSelection,
+  CPResponseLUTSelection,
  
   CPPrefCount
 };
@@ -19,6 +26,13 @@ const char* cpPrefs[CPPrefCount] = {
   [CPLuvUVWSelection]    = "LuvUVWSelection",
   [CPLabLchSelection]    = "LabLchSelection",
   [CPYuvYupvpSelection]  = "YuvYupvpSelection",
+
+  [CPThreeDeeRendererSelection] = "ThreeDeeRendererSelection",
+
+  [CPColorLUTSelection] = "ColorLUTSelection",
+  [CPWellDitherSelection] = "WellDitherSelection",
+  [CPProgressiveWellsSelection] = "ProgressiveWellsSelection",
+  [CPResponseLUTSelection] = "ResponseLUTSelection",
 };
 
 
@@ -46,6 +60,28 @@ void initPreferences(){
     cpPrefs[CPYuvYupvpSelection],
     Yupvp,
     YuvYupvpSelectCount);
+
+  naInitPreferencesEnum(
+    cpPrefs[CPThreeDeeRendererSelection],
+    ThreeDeeRendererBuffers,
+    ThreeDeeRendererSelectCount);
+
+  naInitPreferencesEnum(
+    cpPrefs[CPColorLUTSelection],
+    ColorLUTOff,
+    ColorLUTSelectCount);
+  naInitPreferencesEnum(
+    cpPrefs[CPWellDitherSelection],
+    WellDitherOrdered,
+    WellDitherSelectCount);
+  naInitPreferencesEnum(
+    cpPrefs[CPProgressiveWellsSelection],
+    ProgressiveWellsOn,
+    ProgressiveWellsSelectCount);
+  naInitPreferencesEnum(
+    cpPrefs[CPResponseLUTSelection],
+    ResponseLUTExact,
+    ResponseLUTSelectCount);
 }
 
 
@@ -95,3 +131,58 @@ void cpSetPrefsYuvYupvpSelect(YuvYupvpSelect selection){
 }
 
 
+
+// Selects how the 3D view submits its geometry. The immediate mode renderer
+// is the original one and is kept for comparison.
+ThreeDeeRendererSelect cpGetPrefsThreeDeeRendererSelect(){
+  return (ThreeDeeRendererSelect)naGetPreferencesEnum(cpPrefs[CPThreeDeeRendererSelection]);
+}
+void cpSetPrefsThreeDeeRendererSelect(ThreeDeeRendererSelect selection){
+  naSetPreferencesEnum(cpPrefs[CPThreeDeeRendererSelection], selection);
+}
+
+
+
+// Selects whether the colors of the wells and of the point cloud are
+// interpolated in lookup tables and how many grid points these have per axis.
+// Takes effect at the next start of the application.
+ColorLUTSelect cpGetPrefsColorLUTSelect(){
+  return (ColorLUTSelect)naGetPreferencesEnum(cpPrefs[CPColorLUTSelection]);
+}
+void cpSetPrefsColorLUTSelect(ColorLUTSelect selection){
+  naSetPreferencesEnum(cpPrefs[CPColorLUTSelection], selection);
+}
+
+
+
+// Selects whether the 8 bit colors of the wells get ordered dithering which
+// hides the banding in smooth gradients.
+WellDitherSelect cpGetPrefsWellDitherSelect(){
+  return (WellDitherSelect)naGetPreferencesEnum(cpPrefs[CPWellDitherSelection]);
+}
+void cpSetPrefsWellDitherSelect(WellDitherSelect selection){
+  naSetPreferencesEnum(cpPrefs[CPWellDitherSelection], selection);
+}
+
+
+
+// Selects whether the wells are first computed in a coarse preview while
+// the user is changing the color, followed by the full resolution.
+ProgressiveWellsSelect cpGetPrefsProgressiveWellsSelect(){
+  return (ProgressiveWellsSelect)naGetPreferencesEnum(cpPrefs[CPProgressiveWellsSelection]);
+}
+void cpSetPrefsProgressiveWellsSelect(ProgressiveWellsSelect selection){
+  naSetPreferencesEnum(cpPrefs[CPProgressiveWellsSelection], selection);
+}
+
+
+
+// Selects whether the response curves of the RGB conversions are evaluated
+// exactly or interpolated in tables of 4096 entries per channel. Colors
+// which the color LUTs cover are not affected. Takes effect after a restart.
+ResponseLUTSelect cpGetPrefsResponseLUTSelect(){
+  return (ResponseLUTSelect)naGetPreferencesEnum(cpPrefs[CPResponseLUTSelection]);
+}
+void cpSetPrefsResponseLUTSelect(ResponseLUTSelect selection){
+  naSetPreferencesEnum(cpPrefs[CPResponseLUTSelection], selection);
+}
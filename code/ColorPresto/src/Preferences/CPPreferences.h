@@ -18,6 +18,21 @@ void cpSetPrefsLabLchSelect(LabLchSelect selection);
 YuvYupvpSelect cpGetPrefsYuvYupvpSelect(void);
 void cpSetPrefsYuvYupvpSelect(YuvYupvpSelect selection);
 
+ThreeDeeRendererSelect cpGetPrefsThreeDeeRendererSelect(void);
+void cpSetPrefsThreeDeeRendererSelect(ThreeDeeRendererSelect selection);
+
+ColorLUTSelect cpGetPrefsColorLUTSelect(void);
+void cpSetPrefsColorLUTSelect(ColorLUTSelect selection);
+
+WellDitherSelect cpGetPrefsWellDitherSelect(void);
+void cpSetPrefsWellDitherSelect(WellDitherSelect selection);
+
+ProgressiveWellsSelect cpGetPrefsProgressiveWellsSelect(void);
+void cpSetPrefsProgressiveWellsSelect(ProgressiveWellsSelect selection);
+
+ResponseLUTSelect cpGetPrefsResponseLUTSelect(void);
+void cpSetPrefsResponseLUTSelect(ResponseLUTSelect selection);
+
 NALanguageCode3 cpGetPrefsPreferredLanguage(void);
 void cpSetPrefsPreferredLanguage(NALanguageCode3 languageCode);
 
@@ -1,6 +1,7 @@
 
 #include "CPPreferencesController.h"
 
+#include "../CPColorPrestoApplication.h"
 #include "../CPTranslations.h"
 #include "CPPreferences.h"
 #include "../mainC.h"
@@ -24,10 +25,72 @@ struct CPPreferencesController {
   NAMenuItem* languageJapanese;
   NAMenuItem* languageChinese;
   NAMenuItem* languageReport;
+
+  NALabel* threeDeeRendererLabel;
+  NASelect* threeDeeRendererSelect;
+  NAMenuItem* threeDeeRendererItems[ThreeDeeRendererSelectCount];
+
+  NALabel* colorLUTLabel;
+  NASelect* colorLUTSelect;
+  NAMenuItem* colorLUTItems[ColorLUTSelectCount];
+
+  NALabel* responseLUTLabel;
+  NASelect* responseLUTSelect;
+  NAMenuItem* responseLUTItems[ResponseLUTSelectCount];
+
+  NALabel* wellDitherLabel;
+  NASelect* wellDitherSelect;
+  NAMenuItem* wellDitherItems[WellDitherSelectCount];
+
+  NALabel* progressiveWellsLabel;
+  NASelect* progressiveWellsSelect;
+  NAMenuItem* progressiveWellsItems[ProgressiveWellsSelectCount];
 };
 
 
 
+// Returns the index of the item which caused the reaction within items.
+static size_t cp_GetPreferencesItemIndex(NAMenuItem** items, size_t count, const void* uiElement){
+  for(size_t i = 0; i < count; ++i){
+    if(items[i] == uiElement){
+      return i;
+    }
+  }
+  #if NA_DEBUG
+    cpError("Unknown menu item.");
+  #endif
+  return 0;
+}
+
+
+
+// Adds a label and a select with one item per translation id at the given
+// height. The items are stored in the order of the corresponding enum.
+static NASelect* cp_AddPreferencesSelect(
+  NASpace* contentSpace,
+  NALabel** label,
+  NAMenuItem** items,
+  const uint32* itemTextIds,
+  size_t count,
+  uint32 labelTextId,
+  double y,
+  NAReactionCallback callback,
+  CPPreferencesController* con)
+{
+  *label = naNewLabel(cpTranslate(labelTextId), 250);
+  NASelect* select = naNewSelect(150);
+  for(size_t i = 0; i < count; ++i){
+    items[i] = naNewMenuItem(cpTranslate(itemTextIds[i]));
+    naAddSelectMenuItem(select, items[i], NA_NULL);
+    naAddUIReaction(items[i], NA_UI_COMMAND_PRESSED, callback, con);
+  }
+  naAddSpaceChild(contentSpace, *label, naMakePos(20, y));
+  naAddSpaceChild(contentSpace, select, naMakePos(270, y));
+  return select;
+}
+
+
+
 void cp_ChangePreferencesLanguage(NAReaction reaction){
   CPPreferencesController* con = reaction.controller;
 
@@ -57,6 +120,54 @@ void cp_ChangePreferencesLanguage(NAReaction reaction){
 
 
 
+// The renderer is read by the 3D view with every drawing.
+void cp_ChangePreferencesThreeDeeRenderer(NAReaction reaction){
+  CPPreferencesController* con = reaction.controller;
+  size_t index = cp_GetPreferencesItemIndex(con->threeDeeRendererItems, ThreeDeeRendererSelectCount, reaction.uiElement);
+  cpSetPrefsThreeDeeRendererSelect((ThreeDeeRendererSelect)index);
+  cpUpdateThreeDee();
+}
+
+
+
+// The lookup tables are replaced immediately.
+void cp_ChangePreferencesColorLUT(NAReaction reaction){
+  CPPreferencesController* con = reaction.controller;
+  size_t index = cp_GetPreferencesItemIndex(con->colorLUTItems, ColorLUTSelectCount, reaction.uiElement);
+  cpSetPrefsColorLUTSelect((ColorLUTSelect)index);
+  cpResetConversionCaches();
+}
+
+
+
+void cp_ChangePreferencesResponseLUT(NAReaction reaction){
+  CPPreferencesController* con = reaction.controller;
+  size_t index = cp_GetPreferencesItemIndex(con->responseLUTItems, ResponseLUTSelectCount, reaction.uiElement);
+  cpSetPrefsResponseLUTSelect((ResponseLUTSelect)index);
+  cpResetConversionCaches();
+}
+
+
+
+// The dither is part of what the color wells compare before recomputing.
+void cp_ChangePreferencesWellDither(NAReaction reaction){
+  CPPreferencesController* con = reaction.controller;
+  size_t index = cp_GetPreferencesItemIndex(con->wellDitherItems, WellDitherSelectCount, reaction.uiElement);
+  cpSetPrefsWellDitherSelect((WellDitherSelect)index);
+  cpUpdateColor();
+}
+
+
+
+// Takes effect with the next update.
+void cp_ChangePreferencesProgressiveWells(NAReaction reaction){
+  CPPreferencesController* con = reaction.controller;
+  size_t index = cp_GetPreferencesItemIndex(con->progressiveWellsItems, ProgressiveWellsSelectCount, reaction.uiElement);
+  cpSetPrefsProgressiveWellsSelect((ProgressiveWellsSelect)index);
+}
+
+
+
 void cp_ReportBadTranslation(NAReaction reaction){
   NA_UNUSED(reaction);
 
@@ -71,7 +182,7 @@ void cp_ReportBadTranslation(NAReaction reaction){
 CPPreferencesController* cpAllocPreferencesController(void) {
   CPPreferencesController* con = naAlloc(CPPreferencesController);
 
-  NARect windowrect = naMakeRectS(20, 300, 440, 65);
+  NARect windowrect = naMakeRectS(20, 300, 440, 190);
   con->window = naNewWindow(cpTranslate(CPPreferences), windowrect, NA_FALSE, CP_PREFERENCES_WINDOW_STORAGE_TAG);
 
   NASpace* contentSpace = naGetWindowContentSpace(con->window);
@@ -99,8 +210,79 @@ CPPreferencesController* cpAllocPreferencesController(void) {
   naAddSelectMenuItem(con->languageSelect, naNewMenuSeparator(), NA_NULL);
   naAddSelectMenuItem(con->languageSelect, con->languageReport, NA_NULL);
 
-  naAddSpaceChild(contentSpace, con->languageLabel, naMakePos(20, 20));
-  naAddSpaceChild(contentSpace, con->languageSelect, naMakePos(270, 20));
+  naAddSpaceChild(contentSpace, con->languageLabel, naMakePos(20, 145));
+  naAddSpaceChild(contentSpace, con->languageSelect, naMakePos(270, 145));
+
+  const uint32 threeDeeRendererTextIds[ThreeDeeRendererSelectCount] = {
+    CPPreferencesThreeDeeRendererBuffers,
+    CPPreferencesThreeDeeRendererImmediate};
+  con->threeDeeRendererSelect = cp_AddPreferencesSelect(
+    contentSpace,
+    &con->threeDeeRendererLabel,
+    con->threeDeeRendererItems,
+    threeDeeRendererTextIds,
+    ThreeDeeRendererSelectCount,
+    CPPreferencesThreeDeeRenderer,
+    120,
+    cp_ChangePreferencesThreeDeeRenderer,
+    con);
+
+  const uint32 colorLUTTextIds[ColorLUTSelectCount] = {
+    CPPreferencesColorLUTOff,
+    CPPreferencesColorLUT33,
+    CPPreferencesColorLUT65};
+  con->colorLUTSelect = cp_AddPreferencesSelect(
+    contentSpace,
+    &con->colorLUTLabel,
+    con->colorLUTItems,
+    colorLUTTextIds,
+    ColorLUTSelectCount,
+    CPPreferencesColorLUT,
+    95,
+    cp_ChangePreferencesColorLUT,
+    con);
+
+  const uint32 responseLUTTextIds[ResponseLUTSelectCount] = {
+    CPPreferencesResponseLUTExact,
+    CPPreferencesResponseLUT4096};
+  con->responseLUTSelect = cp_AddPreferencesSelect(
+    contentSpace,
+    &con->responseLUTLabel,
+    con->responseLUTItems,
+    responseLUTTextIds,
+    ResponseLUTSelectCount,
+    CPPreferencesResponseLUT,
+    70,
+    cp_ChangePreferencesResponseLUT,
+    con);
+
+  const uint32 wellDitherTextIds[WellDitherSelectCount] = {
+    CPPreferencesWellDitherOrdered,
+    CPPreferencesWellDitherOff};
+  con->wellDitherSelect = cp_AddPreferencesSelect(
+    contentSpace,
+    &con->wellDitherLabel,
+    con->wellDitherItems,
+    wellDitherTextIds,
+    WellDitherSelectCount,
+    CPPreferencesWellDither,
+    45,
+    cp_ChangePreferencesWellDither,
+    con);
+
+  const uint32 progressiveWellsTextIds[ProgressiveWellsSelectCount] = {
+    CPPreferencesProgressiveWellsOn,
+    CPPreferencesProgressiveWellsOff};
+  con->progressiveWellsSelect = cp_AddPreferencesSelect(
+    contentSpace,
+    &con->progressiveWellsLabel,
+    con->progressiveWellsItems,
+    progressiveWellsTextIds,
+    ProgressiveWellsSelectCount,
+    CPPreferencesProgressiveWells,
+    20,
+    cp_ChangePreferencesProgressiveWells,
+    con);
 
   naAddUIReaction(con->languageSystem, NA_UI_COMMAND_PRESSED, cp_ChangePreferencesLanguage, con);
   naAddUIReaction(con->languageDeutsch, NA_UI_COMMAND_PRESSED, cp_ChangePreferencesLanguage, con);
@@ -143,4 +325,10 @@ void cpUpdatePreferencesController(CPPreferencesController* con) {
   case NA_LANG_ZHO: naSetSelectItemSelected(con->languageSelect, con->languageChinese); break;
   default: naSetSelectItemSelected(con->languageSelect, con->languageSystem); break;
   }
+
+  naSetSelectItemSelected(con->threeDeeRendererSelect, con->threeDeeRendererItems[cpGetPrefsThreeDeeRendererSelect()]);
+  naSetSelectItemSelected(con->colorLUTSelect, con->colorLUTItems[cpGetPrefsColorLUTSelect()]);
+  naSetSelectItemSelected(con->responseLUTSelect, con->responseLUTItems[cpGetPrefsResponseLUTSelect()]);
+  naSetSelectItemSelected(con->wellDitherSelect, con->wellDitherItems[cpGetPrefsWellDitherSelect()]);
+  naSetSelectItemSelected(con->progressiveWellsSelect, con->progressiveWellsItems[cpGetPrefsProgressiveWellsSelect()]);
 }
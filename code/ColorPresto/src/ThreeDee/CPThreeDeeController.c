@@ -7,11 +7,13 @@
 #include "../mainC.h"
 #include "../CPDesign.h"
 #include "../CPTranslations.h"
+#include "../Preferences/CPPreferences.h"
 #include "CPThreeDeeCoordinateController.h"
 #include "CPThreeDeeOpacityController.h"
 #include "CPThreeDeeOptionsController.h"
 #include "CPThreeDeePerspectiveController.h"
 #include "CPThreeDeeController.h"
+#include "../Core/CPThreeDeeMesh.h"
 #include "CPThreeDeeView.h"
 
 #include "CML.h"
@@ -30,6 +32,9 @@ struct CPThreeDeeController{
   CPThreeDeeOpacityController* opacityController;
   CPThreeDeeOptionsController* optionsController;
   CPThreeDeePerspectiveController* perspectiveController;
+
+  CPThreeDeeMesh* mesh;
+  CPThreeDeeView* view;
     
   NAInt fontId;
   
@@ -41,6 +46,12 @@ void cp_InitThreeDeeOpenGL(void* data){
   CPThreeDeeController* con = (CPThreeDeeController*)data;
   con->fontId = naStartupPixelFont();
   cpInitThreeDeeDisplay(con->display);
+  // A view of a previous initialization is replaced while the context is
+  // current such that its buffers get deleted.
+  if(con->view){
+    cpDeallocThreeDeeView(con->view);
+  }
+  con->view = cpAllocThreeDeeView(cpGetPrefsThreeDeeRendererSelect() == ThreeDeeRendererBuffers);
 }
 
 
@@ -282,42 +293,50 @@ void cpUpdateThreeDeeDisplay(NAReaction reaction){
     cpGetThreeDeePerspectiveControllerRotationAngleEqu(con->perspectiveController));
   NAInt steps3D = cpGetThreeDeeCoordinateControllerSteps3D(con->coordinateController);
 
-  if(1){
-    cpDrawThreeDeeSurfaces(
-      cm,
-      sm,
-      backgroundRGB,
-      axisRGB,
-      cpGetThreeDeeOpacityControllerBodySolid(con->opacityController),
-      cpGetThreeDeeOpacityControllerBodyAlpha(con->opacityController),
-      cpGetThreeDeeOpacityControllerGridAlpha(con->opacityController),
-      cpGetThreeDeeOpacityControllerGridTint(con->opacityController),
-      colorType,
-      steps3D,
-      normedInputConverter,
-      coordConverter,
-      normedOutputConverter,
-      hueIndex);
-  }
-  
   const NABool isGrayColorSpace = colorType == CML_COLOR_Gray;
   float pointsOpacity = cpGetThreeDeeOpacityControllerPointsOpacity(con->opacityController);
-  if(pointsOpacity > 0.f || isGrayColorSpace){
+  NABool showPointCloud = pointsOpacity > 0.f || isGrayColorSpace;
+
+  // Only recomputes the geometry if anything but the camera has changed.
+  cpUpdateThreeDeeMesh(
+    con->mesh,
+    cm,
+    sm,
+    cpGetColorLUTCache(),
+    cpGetResponseLUT(),
+    colorType,
+    coordSysType,
+    steps3D,
+    cpGetColorMachineGeneration(),
+    showPointCloud,
+    normedInputConverter,
+    coordConverter,
+    normedOutputConverter,
+    hueIndex);
+
+  // The renderer may have been changed in the preferences.
+  cpSetThreeDeeViewUseVertexArrays(con->view, cpGetPrefsThreeDeeRendererSelect() == ThreeDeeRendererBuffers);
+  cpDrawThreeDeeSurfaces(
+    con->view,
+    con->mesh,
+    backgroundRGB,
+    axisRGB,
+    cpGetThreeDeeOpacityControllerBodySolid(con->opacityController),
+    cpGetThreeDeeOpacityControllerBodyAlpha(con->opacityController),
+    cpGetThreeDeeOpacityControllerGridAlpha(con->opacityController),
+    cpGetThreeDeeOpacityControllerGridTint(con->opacityController));
+  
+  if(showPointCloud){
     cpDrawThreeDeePointCloud(
-      cm,
-      sm,
+      con->view,
+      con->mesh,
       isGrayColorSpace ? 1.f : pointsOpacity,
-      colorType,
-      steps3D,
-      normedInputConverter,
-      coordConverter,
-      normedOutputConverter,
       curZoom);
   }
 
   if(showSpectrum){
     cpDrawThreeDeeSpectrum(
-      cm,
+      cpGetColorMachineSpectralLocus(),
       normedOutputConverter,
       coordSpace,
       hueIndex);
@@ -346,6 +365,9 @@ CPThreeDeeController* cpAllocThreeDeeController(void){
   con->opacityController = cpAllocThreeDeeOpacityController(con);
   con->optionsController = cpAllocThreeDeeOptionsController(con);
 
+  con->mesh = cpAllocThreeDeeMesh();
+  con->view = NA_NULL;
+
   // The window
   con->window = naNewWindow(
     cpTranslate(CP3DView),
@@ -384,6 +406,10 @@ CPThreeDeeController* cpAllocThreeDeeController(void){
 
 void cpDeallocThreeDeeController(CPThreeDeeController* con){
   naShutdownPixelFont(con->fontId);
+  if(con->view){
+    cpDeallocThreeDeeView(con->view);
+  }
+  cpDeallocThreeDeeMesh(con->mesh);
   naFree(con);
 }
 
@@ -3,18 +3,177 @@
 #include "NAApp/NAApp.h"
 #include "NAMath/NAMath.h"
 #include "NAVisual/NAVisual.h"
+#include "NAUtility/NAMemory.h"
+#include "../Core/CPSpectralLocus.h"
+#include "../Core/CPThreeDeeMesh.h"
 #include "CPThreeDeeView.h"
 #include "../CPDesign.h"
+#include "../CPOpenGLHelper.h"
+
+
+
+// Interleaved layout used by the vertex array renderer.
+typedef struct CPThreeDeeVertex CPThreeDeeVertex;
+struct CPThreeDeeVertex{
+  float pos[3];
+  float color[4];
+};
+
+#define CP_THREEDEE_MAX_ARRAY_PARAMS 5
+
+typedef struct CPThreeDeeVertexArray CPThreeDeeVertexArray;
+struct CPThreeDeeVertexArray{
+  CPThreeDeeVertex* vertices;
+  size_t count;
+  size_t capacity;
+  GLuint buffer;
+  // The colors depend on the mesh as well as on some drawing parameters.
+  NABool valid;
+  size_t meshRevision;
+  float params[CP_THREEDEE_MAX_ARRAY_PARAMS];
+};
+
+struct CPThreeDeeView{
+  NABool useVertexArrays;
+  NABool hasBufferObjects;
+  CPThreeDeeVertexArray quads;
+  CPThreeDeeVertexArray lines;
+  CPThreeDeeVertexArray points;
+};
+
+
+
+static void cp_InitThreeDeeVertexArray(CPThreeDeeView* view, CPThreeDeeVertexArray* array){
+  array->vertices = NA_NULL;
+  array->count = 0;
+  array->capacity = 0;
+  array->buffer = view->hasBufferObjects ? cpGenOpenGLArrayBuffer() : 0;
+  array->valid = NA_FALSE;
+  array->meshRevision = 0;
+}
+
 
 
+CPThreeDeeView* cpAllocThreeDeeView(NABool useVertexArrays){
+  CPThreeDeeView* view = naAlloc(CPThreeDeeView);
+  view->useVertexArrays = useVertexArrays;
+  // Without buffer objects, the vertex arrays stay on the client side. The
+  // buffers are created in any case as the renderer may change later on.
+  view->hasBufferObjects = cpInitOpenGLBufferObjects();
+  cp_InitThreeDeeVertexArray(view, &view->quads);
+  cp_InitThreeDeeVertexArray(view, &view->lines);
+  cp_InitThreeDeeVertexArray(view, &view->points);
+  return view;
+}
+
 
-typedef size_t CMLVec4UInt[CML_MAX_NUMBER_OF_CHANNELS];
 
-inline static void cmlSet4UInt(CMLVec4UInt d, size_t a0, size_t a1, size_t a2, size_t a3){
-  d[0] = a0;
-  d[1] = a1;
-  d[2] = a2;
-  d[3] = a3;
+void cpSetThreeDeeViewUseVertexArrays(CPThreeDeeView* view, NABool useVertexArrays){
+  view->useVertexArrays = useVertexArrays;
+}
+
+
+
+static void cp_ClearThreeDeeVertexArray(CPThreeDeeVertexArray* array){
+  if(array->buffer){
+    cpDeleteOpenGLBuffer(array->buffer);
+  }
+  if(array->vertices){
+    naFree(array->vertices);
+  }
+}
+
+
+
+void cpDeallocThreeDeeView(CPThreeDeeView* view){
+  cp_ClearThreeDeeVertexArray(&view->quads);
+  cp_ClearThreeDeeVertexArray(&view->lines);
+  cp_ClearThreeDeeVertexArray(&view->points);
+  naFree(view);
+}
+
+
+
+static NABool cp_IsThreeDeeVertexArrayCurrent(const CPThreeDeeVertexArray* array, size_t meshRevision, const float* params, size_t paramCount){
+  if(!array->valid || array->meshRevision != meshRevision){
+    return NA_FALSE;
+  }
+  for(size_t i = 0; i < paramCount; ++i){
+    if(array->params[i] != params[i]){
+      return NA_FALSE;
+    }
+  }
+  return NA_TRUE;
+}
+
+
+
+static CPThreeDeeVertex* cp_BeginThreeDeeVertexArray(CPThreeDeeVertexArray* array, size_t count){
+  if(count > array->capacity){
+    if(array->vertices){
+      naFree(array->vertices);
+    }
+    array->vertices = naMalloc((count ? count : 1) * sizeof(CPThreeDeeVertex));
+    array->capacity = count;
+  }
+  array->count = 0;
+  return array->vertices;
+}
+
+
+
+static void cp_EndThreeDeeVertexArray(CPThreeDeeVertexArray* array, size_t count, size_t meshRevision, const float* params, size_t paramCount){
+  array->count = count;
+  array->meshRevision = meshRevision;
+  for(size_t i = 0; i < paramCount; ++i){
+    array->params[i] = params[i];
+  }
+  array->valid = NA_TRUE;
+
+  if(array->buffer){
+    cpBindOpenGLArrayBuffer(array->buffer);
+    cpFillOpenGLArrayBuffer(array->vertices, array->count * sizeof(CPThreeDeeVertex));
+    cpBindOpenGLArrayBuffer(0);
+  }
+}
+
+
+
+static void cp_DrawThreeDeeVertexArray(const CPThreeDeeVertexArray* array, GLenum mode){
+  if(!array->count){
+    return;
+  }
+
+  // With a bound buffer object, the pointers are offsets into the buffer.
+  const char* base = (const char*)array->vertices;
+  if(array->buffer){
+    cpBindOpenGLArrayBuffer(array->buffer);
+    base = NA_NULL;
+  }
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(3, GL_FLOAT, sizeof(CPThreeDeeVertex), base + offsetof(CPThreeDeeVertex, pos));
+  glColorPointer(4, GL_FLOAT, sizeof(CPThreeDeeVertex), base + offsetof(CPThreeDeeVertex, color));
+  glDrawArrays(mode, 0, (GLsizei)array->count);
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+
+  if(array->buffer){
+    cpBindOpenGLArrayBuffer(0);
+  }
+}
+
+
+
+static void cp_SetThreeDeeVertex(CPThreeDeeVertex* vertex, const float* pos, const float* rgb, float tint, const float* tintRGB, float alpha){
+  vertex->pos[0] = pos[0];
+  vertex->pos[1] = pos[1];
+  vertex->pos[2] = pos[2];
+  vertex->color[0] = rgb[0] * tint + tintRGB[0] * (1.f - tint);
+  vertex->color[1] = rgb[1] * tint + tintRGB[1] * (1.f - tint);
+  vertex->color[2] = rgb[2] * tint + tintRGB[2] * (1.f - tint);
+  vertex->color[3] = alpha;
 }
 
 
@@ -119,47 +278,11 @@ void cpSetupThreeDeeModelView(int primeAxis, const double* scale, double curZoom
 
 
 
-void cpDrawThreeDeePointCloud(const CMLColorMachine* cm, const CMLColorMachine* sm, double pointsAlpha, CMLColorType space3D, NAInt steps3D, CMLNormedConverter normedInputConverter, CMLColorConverter coordConverter, CMLNormedConverter normedCoordConverter, double zoom){
-  size_t numChannels = cmlGetNumChannels(space3D);
-
-  CMLVec4UInt steps;
-  switch(space3D){
-  case CML_COLOR_Gray:  cmlSet4UInt(steps, 2 * steps3D, 1, 1, 1); break;
-  case CML_COLOR_HSL:   cmlSet4UInt(steps, 3 * steps3D + 1, steps3D, steps3D, 1); break;
-  case CML_COLOR_HSV:   cmlSet4UInt(steps, 3 * steps3D + 1, steps3D, steps3D, 1); break;
-  case CML_COLOR_Lab:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
-  case CML_COLOR_Lch:   cmlSet4UInt(steps, steps3D, steps3D, 3 * steps3D + 1, 1); break;
-  case CML_COLOR_Luv:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
-  case CML_COLOR_RGB:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
-  case CML_COLOR_UVW:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
-  case CML_COLOR_XYZ:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
-  case CML_COLOR_YCbCr: cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
-  case CML_COLOR_Yupvp: cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
-  case CML_COLOR_Yuv:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
-  case CML_COLOR_Yxy:   cmlSet4UInt(steps, steps3D, steps3D, steps3D, 1); break;
-  default: cmlSet4UInt(steps, 1, 1, 1, 1); break;
-  }
-  
-  size_t totalCloudCount = steps[0] * steps[1] * steps[2] * steps[3];
-  float* cloudNormedColorCoords = (float*)cmlCreateNormedGamutSlice(space3D, steps, NA_NULL, NA_NULL, NA_NULL, NA_NULL, NA_NULL);
-  float* cloudRGBFloatValues      = naMalloc(totalCloudCount * 3 * sizeof(float));
-  float* cloudColorCoords         = naMalloc(totalCloudCount * numChannels * sizeof(float));
-  float* cloudSystemCoords        = naMalloc(totalCloudCount * 3 * sizeof(float));
-  float* cloudNormedSystemCoords  = naMalloc(totalCloudCount * 3 * sizeof(float));
-
-  normedInputConverter(cloudColorCoords, cloudNormedColorCoords, totalCloudCount);
-  coordConverter(cm, cloudSystemCoords, cloudColorCoords, totalCloudCount);
-  normedCoordConverter(cloudNormedSystemCoords, cloudSystemCoords, totalCloudCount);
-  
-  // Convert the given values to screen RGBs.
-  fillRGBFloatArrayWithArray(
-    cm,
-    sm,
-    cloudRGBFloatValues,
-    cloudNormedColorCoords,
-    space3D,
-    normedInputConverter,
-    totalCloudCount);
+static void cp_DrawThreeDeePointCloudImmediate(const CPThreeDeeMesh* mesh, double pointsAlpha, double zoom){
+  size_t numChannels = cmlGetNumChannels(cpGetThreeDeeMeshColorType(mesh));
+  size_t totalCloudCount = cpGetThreeDeeMeshPointCount(mesh);
+  const float* cloudRGBFloatValues = cpGetThreeDeeMeshPointRGB(mesh);
+  const float* cloudNormedSystemCoords = cpGetThreeDeeMeshPointCoords(mesh);
 
   glDisable(GL_DEPTH_TEST);
   
@@ -170,497 +293,274 @@ void cpDrawThreeDeePointCloud(const CMLColorMachine* cm, const CMLColorMachine*
     glVertex3fv(&(cloudNormedSystemCoords[i * 3]));
   }
   glEnd();
-  
-//    glEnableClientState(GL_COLOR_ARRAY);
-//    glColorPointer(3, GL_UNSIGNED_BYTE, 0, cloudrgb8Bitvalues);
-//    glEnableClientState(GL_VERTEX_ARRAY);
-//    glVertexPointer(3, GL_FLOAT, 0, cloudNormedSystemCoords);
-//    glDrawArrays(GL_POINTS, 0, totalCloudCount);
-//    glDisableClientState(GL_COLOR_ARRAY);
-//    glDisableClientState(GL_VERTEX_ARRAY);
-
-  naFree(cloudNormedSystemCoords);
-  naFree(cloudSystemCoords);
-  naFree(cloudColorCoords);
-  naFree(cloudRGBFloatValues);
-  naFree(cloudNormedColorCoords);
 }
 
 
 
-void cpDrawThreeDeeSurfaces(const CMLColorMachine* cm, const CMLColorMachine* sm, const CMLVec3 backgroundRGB, const CMLVec3 axisRGB, NABool bodySolid, double bodyAlpha, double gridAlpha, double gridTint, CMLColorType space3D, NAInt steps3D, CMLNormedConverter normedInputConverter, CMLColorConverter coordConverter, CMLNormedConverter normedCoordConverter, NAInt hueIndex){
-  if(!bodySolid){
-//    glClear(GL_DEPTH_BUFFER_BIT);
-  }
+static void cp_DrawThreeDeeSurfacesImmediate(const CPThreeDeeMesh* mesh, const CMLVec3 backgroundRGB, const CMLVec3 axisRGB, NABool bodySolid, double bodyAlpha, double gridAlpha, double gridTint){
   glEnable(GL_DEPTH_TEST);
   
-  size_t numChannels = cmlGetNumChannels(space3D);
-  size_t surfaceCount = 0;
-  CMLVec4UInt* surfaceSteps = NULL;
-  CMLVec4* origins = NULL;
-  CMLVec4* axis1s = NULL;
-  CMLVec4* axis2s = NULL;
-  switch(space3D){
-  case CML_COLOR_Gray:  surfaceCount = 0; break;
-  case CML_COLOR_HSL:   surfaceCount = 3; break;
-  case CML_COLOR_HSV:   surfaceCount = 2; break;
-  case CML_COLOR_Lab:   surfaceCount = 6; break;
-  case CML_COLOR_Lch:   surfaceCount = 3; break;
-  case CML_COLOR_Luv:   surfaceCount = 5; break;
-  case CML_COLOR_RGB:   surfaceCount = 6; break;
-  case CML_COLOR_UVW:   surfaceCount = 5; break;
-  case CML_COLOR_XYZ:   surfaceCount = 6; break;
-  case CML_COLOR_YCbCr: surfaceCount = 6; break;
-  case CML_COLOR_Ycd:   surfaceCount = 6; break;
-  case CML_COLOR_Yupvp: surfaceCount = 4; break;
-  case CML_COLOR_Yuv:   surfaceCount = 4; break;
-  case CML_COLOR_Yxy:   surfaceCount = 4; break;
-  default: break;
+  size_t surfaceCount = cpGetThreeDeeMeshSurfaceCount(mesh);
+  if(!surfaceCount){
+    return;
   }
 
-  if(surfaceCount){
-    surfaceSteps = naMalloc(surfaceCount * sizeof(CMLVec4UInt));
-    origins = naMalloc(surfaceCount * sizeof(CMLVec4));
-    axis1s = naMalloc(surfaceCount * sizeof(CMLVec4));
-    axis2s = naMalloc(surfaceCount * sizeof(CMLVec4));
-    float** normedColorCoords = naMalloc(surfaceCount * sizeof(float*));
-    float** rgbFloatValues = naMalloc(surfaceCount * sizeof(float*));
-    float** colorCoords = naMalloc(surfaceCount * sizeof(float*));
-    float** systemCoords = naMalloc(surfaceCount * sizeof(float*));
-    float** normedSystemCoords = naMalloc(surfaceCount * sizeof(float*));
-    
-    switch(space3D){
-    case CML_COLOR_Gray: break;
-    case CML_COLOR_HSL:
-      cmlSet4UInt(surfaceSteps[0], steps3D * 3 + 1, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D * 3 + 1, steps3D, 1, 1);
-      cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[1], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D * 3 + 1, 1, 1);
-      cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[2], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[2], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_HSV:
-      cmlSet4UInt(surfaceSteps[0], steps3D * 3 + 1, steps3D, 1, 1);
-      cmlSet4(origins[0], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[0], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D * 3 + 1, 1, 1);
-      cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[1], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[1], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_Lab:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_Lch:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D * 3 + 1, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D * 3 + 1, 1, 1);
-      cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[1], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D * 3 + 1, steps3D, 1, 1);
-      cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[2], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[2], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_Luv:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[1], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[1], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[2], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[2], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[3], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[4], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[4], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_RGB:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_UVW:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[1], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[1], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[2], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[2], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[3], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[4], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[4], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_XYZ:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_YCbCr:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_Ycd:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[0], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[1], 0.f, 1.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[2], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[2], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[3], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[4], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[4], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[4], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[4], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[5], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[5], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[5], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[5], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_Yupvp:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[1], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[2], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[2], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[3], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_Yuv:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[1], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[2], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[2], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[3], -1.f, 0.f, 0.f, 0.f);
-      break;
-    case CML_COLOR_Yxy:
-      cmlSet4UInt(surfaceSteps[0], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[0], 0.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis1s[0], 0.f, 0.f, 1.f, 0.f);
-      cmlSet4(axis2s[0], 1.f, 0.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[1], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[1], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[1], -1.f, 0.f, 0.f, 0.f);
-      cmlSet4(axis2s[1], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4UInt(surfaceSteps[2], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[2], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[2], 0.f, -1.f, 0.f, 0.f);
-      cmlSet4(axis2s[2], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4UInt(surfaceSteps[3], steps3D, steps3D, 1, 1);
-      cmlSet4(origins[3], 1.f, 1.f, 1.f, 1.f);
-      cmlSet4(axis1s[3], 0.f, 0.f, -1.f, 0.f);
-      cmlSet4(axis2s[3], -1.f, 0.f, 0.f, 0.f);
-      break;
-    default: break;
+  // ////////////////////
+  // Draw the quads
+  // ////////////////////
+
+  for(size_t s = 0; s < surfaceCount; ++s){
+    size_t steps1 = cpGetThreeDeeMeshSurfaceSteps1(mesh, s);
+    size_t steps2 = cpGetThreeDeeMeshSurfaceSteps2(mesh, s);
+    const float* normedSystemCoords = cpGetThreeDeeMeshSurfaceCoords(mesh, s);
+    const float* rgbFloatValues = cpGetThreeDeeMeshSurfaceRGB(mesh, s);
+
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.f, 1.f);
+    glShadeModel(GL_FLAT);
+    glBegin(GL_QUADS);
+    for(size_t ax1 = 0; ax1 < steps2 - 1; ax1++){
+      for(size_t ax2 = 0; ax2 < steps1 - 1; ax2++){
+        if(!cpIsThreeDeeMeshCellVisible(mesh, s, ax1 * (steps1 - 1) + ax2)){
+          continue;
+        }
+        size_t index0 = (ax1 + 0) * steps1 * 3 + (ax2 + 0) * 3;
+        size_t index1 = (ax1 + 0) * steps1 * 3 + (ax2 + 1) * 3;
+        size_t index2 = (ax1 + 1) * steps1 * 3 + (ax2 + 1) * 3;
+        size_t index3 = (ax1 + 1) * steps1 * 3 + (ax2 + 0) * 3;
+
+        glColor4f(
+          rgbFloatValues[index3 + 0] * (float)bodyAlpha + backgroundRGB[0] * (1.f - (float)bodyAlpha),
+          rgbFloatValues[index3 + 1] * (float)bodyAlpha + backgroundRGB[1] * (1.f - (float)bodyAlpha),
+          rgbFloatValues[index3 + 2] * (float)bodyAlpha + backgroundRGB[2] * (1.f - (float)bodyAlpha),
+          1.f);
+
+        glVertex3fv(&(normedSystemCoords[index0]));
+        glVertex3fv(&(normedSystemCoords[index1]));
+        glVertex3fv(&(normedSystemCoords[index2]));
+        glVertex3fv(&(normedSystemCoords[index3]));
+      }
     }
+    glEnd();
+    glPolygonOffset(0.f, 0.f);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+  }
 
-    for(size_t s = 0; s < surfaceCount; ++s){
-      size_t totalCount = surfaceSteps[s][0] * surfaceSteps[s][1] * surfaceSteps[s][2] * surfaceSteps[s][3];
-      normedColorCoords[s] = (float*)cmlCreateNormedGamutSlice(space3D, surfaceSteps[s], origins[s], axis1s[s], axis2s[s], NULL, NULL);
-      rgbFloatValues[s] = naMalloc(totalCount * 3 * sizeof(float));
-      colorCoords[s] = naMalloc(totalCount * numChannels * sizeof(float));
-      systemCoords[s] = naMalloc(totalCount * 3 * sizeof(float));
-      normedSystemCoords[s] = naMalloc(totalCount * 3 * sizeof(float));
-
-      normedInputConverter(colorCoords[s], normedColorCoords[s], totalCount);
-      coordConverter(cm, systemCoords[s], colorCoords[s], totalCount);
-      normedCoordConverter(normedSystemCoords[s], systemCoords[s], totalCount);
-      
-      // Convert the given values to screen RGBs.
-      fillRGBFloatArrayWithArray(
-        cm,
-        sm,
-        rgbFloatValues[s],
-        normedColorCoords[s],
-        space3D,
-        normedInputConverter,
-        totalCount);
+  if(!bodySolid){
+    glClear(GL_DEPTH_BUFFER_BIT);
+  }
+
+  // ////////////////////
+  // Draw the lines
+  // ////////////////////
+
+  for(size_t s = 0; s < surfaceCount; ++s){
+    if(gridAlpha > 0.f){
+      size_t steps1 = cpGetThreeDeeMeshSurfaceSteps1(mesh, s);
+      size_t steps2 = cpGetThreeDeeMeshSurfaceSteps2(mesh, s);
+      const float* normedSystemCoords = cpGetThreeDeeMeshSurfaceCoords(mesh, s);
+      const float* rgbFloatValues = cpGetThreeDeeMeshSurfaceRGB(mesh, s);
+
+      glShadeModel(GL_SMOOTH);
+      glDepthFunc(GL_LEQUAL);
+      for(size_t ax1 = 0; ax1 < steps2 - 1; ax1++){
+        for(size_t ax2 = 0; ax2 < steps1 - 1; ax2++){
+          if(!cpIsThreeDeeMeshCellVisible(mesh, s, ax1 * (steps1 - 1) + ax2)){
+            continue;
+          }
+          size_t index0 = (ax1 + 0) * steps1 * 3 + (ax2 + 0) * 3;
+          size_t index1 = (ax1 + 0) * steps1 * 3 + (ax2 + 1) * 3;
+          size_t index2 = (ax1 + 1) * steps1 * 3 + (ax2 + 1) * 3;
+          size_t index3 = (ax1 + 1) * steps1 * 3 + (ax2 + 0) * 3;
+          glBegin(GL_LINE_STRIP);
+          glColor4f( rgbFloatValues[index0 + 0] * (float)gridTint + axisRGB[0] * (1.f - (float)gridTint),
+                      rgbFloatValues[index0 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
+                      rgbFloatValues[index0 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
+          glVertex3fv(&(normedSystemCoords[index0]));
+          glColor4f( rgbFloatValues[index1 + 0] * (float)gridTint + axisRGB[0] * (1.f - (float)gridTint),
+                      rgbFloatValues[index1 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
+                      rgbFloatValues[index1 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
+          glVertex3fv(&(normedSystemCoords[index1]));
+          glColor4f( rgbFloatValues[index2 + 0] * (float)gridTint + axisRGB[0] * (1.f - (float)gridTint),
+                      rgbFloatValues[index2 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
+                      rgbFloatValues[index2 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
+          glVertex3fv(&(normedSystemCoords[index2]));
+          glColor4f( rgbFloatValues[index3 + 0] * (float)gridTint + axisRGB[0] * (1.f -(float) gridTint),
+                      rgbFloatValues[index3 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
+                      rgbFloatValues[index3 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
+          glVertex3fv(&(normedSystemCoords[index3]));
+          glColor4f( rgbFloatValues[index0 + 0] * (float)gridTint + axisRGB[0] * (1.f - (float)gridTint),
+                      rgbFloatValues[index0 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
+                      rgbFloatValues[index0 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
+          glVertex3fv(&(normedSystemCoords[index0]));
+
+          glEnd();
+        }
+      }
+      glDepthFunc(GL_LESS);
+    }
+  }
+}
+
+
+
+static void cp_DrawThreeDeePointCloudVertexArray(CPThreeDeeView* view, const CPThreeDeeMesh* mesh, double pointsAlpha, double zoom){
+  size_t numChannels = cmlGetNumChannels(cpGetThreeDeeMeshColorType(mesh));
+  size_t revision = cpGetThreeDeeMeshPointRevision(mesh);
+  float params[1] = {(float)pointsAlpha};
+  CPThreeDeeVertexArray* array = &view->points;
+
+  if(!cp_IsThreeDeeVertexArrayCurrent(array, revision, params, 1)){
+    size_t totalCloudCount = cpGetThreeDeeMeshPointCount(mesh);
+    const float* cloudRGBFloatValues = cpGetThreeDeeMeshPointRGB(mesh);
+    const float* cloudNormedSystemCoords = cpGetThreeDeeMeshPointCoords(mesh);
+    const float noTint[3] = {0.f, 0.f, 0.f};
+
+    CPThreeDeeVertex* vertices = cp_BeginThreeDeeVertexArray(array, totalCloudCount);
+    for(size_t i = 0; i < totalCloudCount; ++i){
+      cp_SetThreeDeeVertex(&vertices[i], &cloudNormedSystemCoords[i * 3], &cloudRGBFloatValues[i * 3], 1.f, noTint, (float)pointsAlpha);
     }
+    cp_EndThreeDeeVertexArray(array, totalCloudCount, revision, params, 1);
+  }
+
+  glDisable(GL_DEPTH_TEST);
+  glPointSize((2.f / numChannels) / (float)zoom);
+  cp_DrawThreeDeeVertexArray(array, GL_POINTS);
+}
+
+
+
+static void cp_DrawThreeDeeSurfacesVertexArray(CPThreeDeeView* view, const CPThreeDeeMesh* mesh, const CMLVec3 backgroundRGB, const CMLVec3 axisRGB, NABool bodySolid, double bodyAlpha, double gridAlpha, double gridTint){
+  glEnable(GL_DEPTH_TEST);
+
+  size_t surfaceCount = cpGetThreeDeeMeshSurfaceCount(mesh);
+  if(!surfaceCount){
+    return;
+  }
 
-    // ////////////////////
-    // Draw the quads
-    // ////////////////////
+  size_t revision = cpGetThreeDeeMeshSurfaceRevision(mesh);
+  size_t cellCount = cpGetThreeDeeMeshVisibleCellCount(mesh);
 
+  // ////////////////////
+  // Draw the quads
+  // ////////////////////
+
+  float quadParams[4] = {(float)bodyAlpha, backgroundRGB[0], backgroundRGB[1], backgroundRGB[2]};
+  if(!cp_IsThreeDeeVertexArrayCurrent(&view->quads, revision, quadParams, 4)){
+    CPThreeDeeVertex* vertex = cp_BeginThreeDeeVertexArray(&view->quads, cellCount * 4);
     for(size_t s = 0; s < surfaceCount; ++s){
-      glEnable(GL_POLYGON_OFFSET_FILL);
-      glPolygonOffset(1.f, 1.f);
-      glShadeModel(GL_FLAT);
-      glBegin(GL_QUADS);
-      for(size_t ax1 = 0; ax1 < surfaceSteps[s][1] - 1; ax1++){
-        for(size_t ax2 = 0; ax2 < surfaceSteps[s][0] - 1; ax2++){
-          size_t index0 = (ax1 + 0) * surfaceSteps[s][0] * 3 + (ax2 + 0) * 3;
-          size_t index1 = (ax1 + 0) * surfaceSteps[s][0] * 3 + (ax2 + 1) * 3;
-          size_t index2 = (ax1 + 1) * surfaceSteps[s][0] * 3 + (ax2 + 1) * 3;
-          size_t index3 = (ax1 + 1) * surfaceSteps[s][0] * 3 + (ax2 + 0) * 3;
-
-          glColor4f(
-            rgbFloatValues[s][index3 + 0] * (float)bodyAlpha + backgroundRGB[0] * (1.f - (float)bodyAlpha),
-            rgbFloatValues[s][index3 + 1] * (float)bodyAlpha + backgroundRGB[1] * (1.f - (float)bodyAlpha),
-            rgbFloatValues[s][index3 + 2] * (float)bodyAlpha + backgroundRGB[2] * (1.f - (float)bodyAlpha),
-            1.f);
-
-          if(hueIndex >= 0){
-            if(    (fabsf(normedSystemCoords[s][index0 + hueIndex] - normedSystemCoords[s][index1 + hueIndex]) > .5f)
-                || (fabsf(normedSystemCoords[s][index0 + hueIndex] - normedSystemCoords[s][index2 + hueIndex]) > .5f)
-                || (fabsf(normedSystemCoords[s][index0 + hueIndex] - normedSystemCoords[s][index3 + hueIndex]) > .5f)){
-              continue;
-            }
+      size_t steps1 = cpGetThreeDeeMeshSurfaceSteps1(mesh, s);
+      size_t steps2 = cpGetThreeDeeMeshSurfaceSteps2(mesh, s);
+      const float* normedSystemCoords = cpGetThreeDeeMeshSurfaceCoords(mesh, s);
+      const float* rgbFloatValues = cpGetThreeDeeMeshSurfaceRGB(mesh, s);
+      for(size_t ax1 = 0; ax1 < steps2 - 1; ax1++){
+        for(size_t ax2 = 0; ax2 < steps1 - 1; ax2++){
+          if(!cpIsThreeDeeMeshCellVisible(mesh, s, ax1 * (steps1 - 1) + ax2)){
+            continue;
           }
-          
-          glVertex3fv(&(normedSystemCoords[s][index0]));
-          glVertex3fv(&(normedSystemCoords[s][index1]));
-          glVertex3fv(&(normedSystemCoords[s][index2]));
-          glVertex3fv(&(normedSystemCoords[s][index3]));
+          size_t index0 = (ax1 + 0) * steps1 * 3 + (ax2 + 0) * 3;
+          size_t index1 = (ax1 + 0) * steps1 * 3 + (ax2 + 1) * 3;
+          size_t index2 = (ax1 + 1) * steps1 * 3 + (ax2 + 1) * 3;
+          size_t index3 = (ax1 + 1) * steps1 * 3 + (ax2 + 0) * 3;
+          // Flat shaded: all four corners get the color of the last one.
+          const float* rgb = &rgbFloatValues[index3];
+          cp_SetThreeDeeVertex(vertex++, &normedSystemCoords[index0], rgb, (float)bodyAlpha, backgroundRGB, 1.f);
+          cp_SetThreeDeeVertex(vertex++, &normedSystemCoords[index1], rgb, (float)bodyAlpha, backgroundRGB, 1.f);
+          cp_SetThreeDeeVertex(vertex++, &normedSystemCoords[index2], rgb, (float)bodyAlpha, backgroundRGB, 1.f);
+          cp_SetThreeDeeVertex(vertex++, &normedSystemCoords[index3], rgb, (float)bodyAlpha, backgroundRGB, 1.f);
         }
       }
-      glEnd();
-      glPolygonOffset(0.f, 0.f);
-      glDisable(GL_POLYGON_OFFSET_FILL);
     }
+    cp_EndThreeDeeVertexArray(&view->quads, cellCount * 4, revision, quadParams, 4);
+  }
 
-    if(!bodySolid){
-      glClear(GL_DEPTH_BUFFER_BIT);
-    }
+  glEnable(GL_POLYGON_OFFSET_FILL);
+  glPolygonOffset(1.f, 1.f);
+  glShadeModel(GL_FLAT);
+  cp_DrawThreeDeeVertexArray(&view->quads, GL_QUADS);
+  glPolygonOffset(0.f, 0.f);
+  glDisable(GL_POLYGON_OFFSET_FILL);
 
-    // ////////////////////
-    // Draw the lines
-    // ////////////////////
+  if(!bodySolid){
+    glClear(GL_DEPTH_BUFFER_BIT);
+  }
 
-    for(size_t s = 0; s < surfaceCount; ++s){
-      if(gridAlpha > 0.f){
-        glShadeModel(GL_SMOOTH);
-        glDepthFunc(GL_LEQUAL);
-        for(size_t ax1 = 0; ax1 < surfaceSteps[s][1] - 1; ax1++){
-          for(size_t ax2 = 0; ax2 < surfaceSteps[s][0] - 1; ax2++){
-            size_t index0 = (ax1 + 0) * surfaceSteps[s][0] * 3 + (ax2 + 0) * 3;
-            size_t index1 = (ax1 + 0) * surfaceSteps[s][0] * 3 + (ax2 + 1) * 3;
-            size_t index2 = (ax1 + 1) * surfaceSteps[s][0] * 3 + (ax2 + 1) * 3;
-            size_t index3 = (ax1 + 1) * surfaceSteps[s][0] * 3 + (ax2 + 0) * 3;
-            if(hueIndex >= 0){
-              if(    (fabsf(normedSystemCoords[s][index0 + hueIndex] - normedSystemCoords[s][index1 + hueIndex]) > .5f)
-                  || (fabsf(normedSystemCoords[s][index0 + hueIndex] - normedSystemCoords[s][index2 + hueIndex]) > .5f)
-                  || (fabsf(normedSystemCoords[s][index0 + hueIndex] - normedSystemCoords[s][index3 + hueIndex]) > .5f)){
-                continue;
-              }
+  // ////////////////////
+  // Draw the lines
+  // ////////////////////
+
+  if(gridAlpha > 0.f){
+    float lineParams[5] = {(float)gridTint, (float)gridAlpha, axisRGB[0], axisRGB[1], axisRGB[2]};
+    if(!cp_IsThreeDeeVertexArrayCurrent(&view->lines, revision, lineParams, 5)){
+      // Every cell outline consists of four separate line segments.
+      CPThreeDeeVertex* vertex = cp_BeginThreeDeeVertexArray(&view->lines, cellCount * 8);
+      for(size_t s = 0; s < surfaceCount; ++s){
+        size_t steps1 = cpGetThreeDeeMeshSurfaceSteps1(mesh, s);
+        size_t steps2 = cpGetThreeDeeMeshSurfaceSteps2(mesh, s);
+        const float* normedSystemCoords = cpGetThreeDeeMeshSurfaceCoords(mesh, s);
+        const float* rgbFloatValues = cpGetThreeDeeMeshSurfaceRGB(mesh, s);
+        for(size_t ax1 = 0; ax1 < steps2 - 1; ax1++){
+          for(size_t ax2 = 0; ax2 < steps1 - 1; ax2++){
+            if(!cpIsThreeDeeMeshCellVisible(mesh, s, ax1 * (steps1 - 1) + ax2)){
+              continue;
+            }
+            size_t indices[5];
+            indices[0] = (ax1 + 0) * steps1 * 3 + (ax2 + 0) * 3;
+            indices[1] = (ax1 + 0) * steps1 * 3 + (ax2 + 1) * 3;
+            indices[2] = (ax1 + 1) * steps1 * 3 + (ax2 + 1) * 3;
+            indices[3] = (ax1 + 1) * steps1 * 3 + (ax2 + 0) * 3;
+            indices[4] = indices[0];
+            for(size_t i = 0; i < 4; ++i){
+              cp_SetThreeDeeVertex(vertex++, &normedSystemCoords[indices[i]], &rgbFloatValues[indices[i]], (float)gridTint, axisRGB, (float)gridAlpha);
+              cp_SetThreeDeeVertex(vertex++, &normedSystemCoords[indices[i + 1]], &rgbFloatValues[indices[i + 1]], (float)gridTint, axisRGB, (float)gridAlpha);
             }
-            glBegin(GL_LINE_STRIP);
-            glColor4f( rgbFloatValues[s][index0 + 0] * (float)gridTint + axisRGB[0] * (1.f - (float)gridTint),
-                        rgbFloatValues[s][index0 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
-                        rgbFloatValues[s][index0 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
-            glVertex3fv(&(normedSystemCoords[s][index0]));
-            glColor4f( rgbFloatValues[s][index1 + 0] * (float)gridTint + axisRGB[0] * (1.f - (float)gridTint),
-                        rgbFloatValues[s][index1 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
-                        rgbFloatValues[s][index1 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
-            glVertex3fv(&(normedSystemCoords[s][index1]));
-            glColor4f( rgbFloatValues[s][index2 + 0] * (float)gridTint + axisRGB[0] * (1.f - (float)gridTint),
-                        rgbFloatValues[s][index2 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
-                        rgbFloatValues[s][index2 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
-            glVertex3fv(&(normedSystemCoords[s][index2]));
-            glColor4f( rgbFloatValues[s][index3 + 0] * (float)gridTint + axisRGB[0] * (1.f -(float) gridTint),
-                        rgbFloatValues[s][index3 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
-                        rgbFloatValues[s][index3 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
-            glVertex3fv(&(normedSystemCoords[s][index3]));
-            glColor4f( rgbFloatValues[s][index0 + 0] * (float)gridTint + axisRGB[0] * (1.f - (float)gridTint),
-                        rgbFloatValues[s][index0 + 1] * (float)gridTint + axisRGB[1] * (1.f - (float)gridTint),
-                        rgbFloatValues[s][index0 + 2] * (float)gridTint + axisRGB[2] * (1.f - (float)gridTint), (float)gridAlpha);
-            glVertex3fv(&(normedSystemCoords[s][index0]));
-
-            glEnd();
           }
         }
-        glDepthFunc(GL_LESS);
       }
-
+      cp_EndThreeDeeVertexArray(&view->lines, cellCount * 8, revision, lineParams, 5);
     }
 
-    for(size_t s = 0; s < surfaceCount; ++s){
-      naFree(normedSystemCoords[s]);
-      naFree(systemCoords[s]);
-      naFree(colorCoords[s]);
-      naFree(rgbFloatValues[s]);
-      naFree(normedColorCoords[s]);
-    }
+    glShadeModel(GL_SMOOTH);
+    glDepthFunc(GL_LEQUAL);
+    cp_DrawThreeDeeVertexArray(&view->lines, GL_LINES);
+    glDepthFunc(GL_LESS);
+  }
+}
+
+
+
+void cpDrawThreeDeePointCloud(CPThreeDeeView* view, const CPThreeDeeMesh* mesh, double pointsAlpha, double zoom){
+  if(view->useVertexArrays){
+    cp_DrawThreeDeePointCloudVertexArray(view, mesh, pointsAlpha, zoom);
+  }else{
+    cp_DrawThreeDeePointCloudImmediate(mesh, pointsAlpha, zoom);
+  }
+}
+
 
-    naFree(normedColorCoords);
-    naFree(rgbFloatValues);
-    naFree(colorCoords);
-    naFree(systemCoords);
-    naFree(normedSystemCoords);
-    naFree(axis2s);
-    naFree(axis1s);
-    naFree(origins);
-    naFree(surfaceSteps);
+
+void cpDrawThreeDeeSurfaces(CPThreeDeeView* view, const CPThreeDeeMesh* mesh, const CMLVec3 backgroundRGB, const CMLVec3 axisRGB, NABool bodySolid, double bodyAlpha, double gridAlpha, double gridTint){
+  if(view->useVertexArrays){
+    cp_DrawThreeDeeSurfacesVertexArray(view, mesh, backgroundRGB, axisRGB, bodySolid, bodyAlpha, gridAlpha, gridTint);
+  }else{
+    cp_DrawThreeDeeSurfacesImmediate(mesh, backgroundRGB, axisRGB, bodySolid, bodyAlpha, gridAlpha, gridTint);
   }
 }
 
 
 
-void cpDrawThreeDeeSpectrum(const CMLColorMachine* cm, CMLNormedConverter normedCoordConverter, CMLColorType coordSpace, NAInt hueIndex){
-  float iMin = CML_DEFAULT_INTEGRATION_MIN;
-  float iMax = CML_DEFAULT_INTEGRATION_MAX;
-  NAInt intervals = (int32)((iMax - iMin) / CML_DEFAULT_INTEGRATION_STEPSIZE) + 1;
-  
-  CMLColorConverter xyzConverter = cmlGetColorConverter(coordSpace, CML_COLOR_XYZ);
+void cpDrawThreeDeeSpectrum(CPSpectralLocus* locus, CMLNormedConverter normedCoordConverter, CMLColorType coordSpace, NAInt hueIndex){
+  size_t locusCount = cpGetSpectralLocusCount(locus);
+  const float* locusXYZ = cpGetSpectralLocusXYZ(locus);
+  const float* locusRGB = cpGetSpectralLocusRGB(locus);
+  const float* locusNormedCoords = cpGetSpectralLocusNormedCoords(locus, coordSpace, normedCoordConverter);
 
   glBegin(GL_LINE_STRIP);
     float prevNormedHue = -CML_INFINITY;
-    for(NAInt iStep = 0; iStep <= intervals; ++iStep){
-      float l = iMin + (((iMax - iMin) * iStep) / intervals);
-      CMLVec3 curXYZ;
-      cmlGetSpectralXYZColor(cm, curXYZ, l);
-      
-      if(curXYZ[1] > 0.f){
-        CMLVec3 curRGB = {0.f, 0.f, 0.f};
-        CMLVec3 curCoords = {0.f, 0.f, 0.f};
-        CMLVec3 curNormedCoords = {0.f, 0.f, 0.f};
-        xyzConverter(cm, curCoords, curXYZ, 1);
-        normedCoordConverter(curNormedCoords, curCoords, 1);
+    for(size_t i = 0; i < locusCount; ++i){
+      if(locusXYZ[i * 3 + 1] > 0.f){
+        CMLVec3 curRGB;
+        const float* curNormedCoords = &(locusNormedCoords[i * 3]);
         
         if(hueIndex >= 0){
           if((prevNormedHue != -CML_INFINITY) && (fabsf(prevNormedHue - curNormedCoords[hueIndex]) > .5f)){
@@ -673,7 +573,7 @@ void cpDrawThreeDeeSpectrum(const CMLColorMachine* cm, CMLNormedConverter normed
           }
         }
         
-        cmlXYZToRGB(cm, curRGB, curXYZ, 1);
+        cmlCpy3(curRGB, &(locusRGB[i * 3]));
         cmlMul3(curRGB, .7f);
         cmlClampRGB(curRGB, 1);
         cmlMul3(curRGB, .7f);
@@ -3,6 +3,8 @@
 #include "CML.h"
 
 CP_PROTOTYPE(NAOpenGLSpace);
+CP_PROTOTYPE(CPThreeDeeMesh);
+CP_PROTOTYPE(CPSpectralLocus);
 
 
 typedef struct CPThreeDeeView CPThreeDeeView;
@@ -11,6 +13,15 @@ typedef struct CPThreeDeeView CPThreeDeeView;
 
 void cpInitThreeDeeDisplay(NAOpenGLSpace* openGLSpace);
 
+// The view holds the OpenGL resources of the 3D display and must be
+// allocated and deallocated with the OpenGL context being current. If
+// useVertexArrays is false, the geometry is submitted in immediate mode like
+// before. The renderer can be switched at any time, it takes effect with the
+// next drawing.
+CPThreeDeeView* cpAllocThreeDeeView(NABool useVertexArrays);
+void cpDeallocThreeDeeView(CPThreeDeeView* view);
+void cpSetThreeDeeViewUseVertexArrays(CPThreeDeeView* view, NABool useVertexArrays);
+
 void cpBeginThreeDeeDrawing(const CMLVec3 axisRGB);
 void cpEndThreeDeeDrawing(NAOpenGLSpace* openGLSpace);
 
@@ -28,34 +39,23 @@ void cpSetupThreeDeeModelView(
   double viewEqu);
 
 void cpDrawThreeDeePointCloud(
-  const CMLColorMachine* cm,
-  const CMLColorMachine* sm,
+  CPThreeDeeView* view,
+  const CPThreeDeeMesh* mesh,
   double pointsAlpha,
-  CMLColorType space3D,
-  NAInt steps3D,
-  CMLNormedConverter normedInputConverter,
-  CMLColorConverter coordConverter,
-  CMLNormedConverter normedCoordConverter,
   double zoom);
 
 void cpDrawThreeDeeSurfaces(
-  const CMLColorMachine* cm,
-  const CMLColorMachine* sm,
+  CPThreeDeeView* view,
+  const CPThreeDeeMesh* mesh,
   const CMLVec3 backgroundRGB,
   const CMLVec3 axisRGB,
   NABool bodySolid,
   double bodyAlpha,
   double gridAlpha,
-  double gridTint,
-  CMLColorType space3D,
-  NAInt steps3D,
-  CMLNormedConverter normedInputConverter,
-  CMLColorConverter coordConverter,
-  CMLNormedConverter normedCoordConverter,
-  NAInt hueIndex);
+  double gridTint);
 
 void cpDrawThreeDeeSpectrum(
-  const CMLColorMachine* cm, 
+  CPSpectralLocus* locus,
   CMLNormedConverter normedCoordConverter,
   CMLColorType coordSpace,
   NAInt hueIndex);
@@ -14,6 +14,14 @@ CP_PROTOTYPE(CPHSLColorController);
 
 #include "CML.h"
 #include "NABase/NABase.h"
+#include "Core/CPRGBConversion.h"
+
+// Storage class of variables every thread has its own instance of.
+#if NA_OS == NA_OS_WINDOWS
+  #define CP_THREAD_LOCAL __declspec(thread)
+#else
+  #define CP_THREAD_LOCAL __thread
+#endif
 
 
 #define CP_COLOR_PRESTO_STORAGE_TAG       1
@@ -46,6 +54,37 @@ typedef enum {
   YuvYupvpSelectCount
 } YuvYupvpSelect;
 
+typedef enum {
+  ThreeDeeRendererBuffers,
+  ThreeDeeRendererImmediate,
+  ThreeDeeRendererSelectCount
+} ThreeDeeRendererSelect;
+
+typedef enum {
+  ColorLUTOff,
+  ColorLUT33,
+  ColorLUT65,
+  ColorLUTSelectCount
+} ColorLUTSelect;
+
+typedef enum {
+  WellDitherOrdered,
+  WellDitherOff,
+  WellDitherSelectCount
+} WellDitherSelect;
+
+typedef enum {
+  ProgressiveWellsOn,
+  ProgressiveWellsOff,
+  ProgressiveWellsSelectCount
+} ProgressiveWellsSelect;
+
+typedef enum {
+  ResponseLUTExact,
+  ResponseLUT4096,
+  ResponseLUTSelectCount
+} ResponseLUTSelect;
+
 
 
 
@@ -54,9 +93,8 @@ const CPColorController* cpGetCurrentColorController(void);
 
 const float* cpGetCurrentColorData(void);
 CMLColorType cpGetCurrentColorType(void);
+const float* cpGetCurrentColorYxy(void);
 
 
-void fillRGBFloatArrayWithArray(const CMLColorMachine* cm, const CMLColorMachine* sm, float* texdata, const float* inputarray, CMLColorType inputColorType, CMLNormedConverter normedConverter, size_t count);
-
 
 #endif // CP_MAIN_INCLUDED